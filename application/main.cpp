@@ -1,6 +1,8 @@
 #include "../cli/mainfeatures.h"
 #include "../gui/initiate.h"
 
+#include "./tracing.h"
+
 #include "resources/config.h"
 
 #if defined(VIDEODOWNLOADER_GUI_QTWIDGETS) || defined(VIDEODOWNLOADER_GUI_QTQUICK)
@@ -44,8 +46,17 @@ int main(int argc, char *argv[])
     // parse arguments
     parser.parseArgs(argc, argv);
     // set meta info for application
+    int res = 0;
     if (qtConfigArgs.areQtGuiArgsPresent()) {
-        return QtGui::runWidgetsGui(argc, argv, qtConfigArgs);
+        res = QtGui::runWidgetsGui(argc, argv, qtConfigArgs);
+    }
+#ifdef VIDEODOWNLOADER_TRACING
+    // save trace events if requested via environment (useful when running without GUI)
+    if (const auto tracePath = qEnvironmentVariable("VIDEODOWNLOADER_TRACE_FILE"); !tracePath.isEmpty()) {
+        if (!Application::Tracing::dumpChromeTrace(tracePath)) {
+            cerr << "Unable to write trace to \"" << tracePath.toLocal8Bit().data() << "\"." << endl;
+        }
     }
-    return 0;
+#endif
+    return res;
 }
@@ -0,0 +1,174 @@
+#include "./tracing.h"
+
+#ifdef VIDEODOWNLOADER_TRACING
+
+#include <QFile>
+#include <QString>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Application {
+
+namespace Tracing {
+
+/*!
+ * \brief The Event struct holds a single trace event; the duration is negative for instant events.
+ */
+struct Event {
+    const char *name;
+    qint64 begin;
+    qint64 duration;
+};
+
+/*!
+ * \brief The Buffer struct is the ring buffer of a single thread.
+ *
+ * Only the owning thread writes events. The write position is published atomically so events can be
+ * read from another thread without locking; events which might be overwritten while reading are skipped.
+ */
+struct Buffer {
+    static constexpr std::size_t capacity = 1 << 16;
+    explicit Buffer(int threadId);
+    void add(const char *name, qint64 begin, qint64 duration);
+
+    std::array<Event, capacity> events;
+    std::atomic<std::size_t> written;
+    const int threadId;
+};
+
+/*!
+ * \brief Constructs an empty buffer for the thread with the specified \a threadId.
+ */
+Buffer::Buffer(int threadId)
+    : events()
+    , written(0)
+    , threadId(threadId)
+{
+}
+
+/*!
+ * \brief Adds an event to the buffer, overwriting the oldest one if the buffer is full.
+ */
+void Buffer::add(const char *name, qint64 begin, qint64 duration)
+{
+    const auto index = written.load(std::memory_order_relaxed);
+    events[index % capacity] = Event{ name, begin, duration };
+    written.store(index + 1, std::memory_order_release);
+}
+
+/*!
+ * \brief Returns the registry of the buffers of all threads which recorded events so far.
+ * \remarks The buffers are kept after their thread exited so their events can still be dumped.
+ */
+static std::pair<std::mutex, std::vector<std::shared_ptr<Buffer>>> &registry()
+{
+    static std::pair<std::mutex, std::vector<std::shared_ptr<Buffer>>> registry;
+    return registry;
+}
+
+/*!
+ * \brief Returns the buffer of the current thread; registers it on first use.
+ */
+static Buffer &threadBuffer()
+{
+    thread_local const std::shared_ptr<Buffer> buffer = [] {
+        auto &[mutex, buffers] = registry();
+        const std::lock_guard<std::mutex> lock(mutex);
+        buffers.emplace_back(std::make_shared<Buffer>(static_cast<int>(buffers.size()) + 1));
+        return buffers.back();
+    }();
+    return *buffer;
+}
+
+/*!
+ * \brief Returns the current time in microseconds.
+ */
+qint64 now()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*!
+ * \brief Records an event with the specified \a name which has been running from \a begin to \a end.
+ */
+void recordComplete(const char *name, qint64 begin, qint64 end)
+{
+    threadBuffer().add(name, begin, end - begin);
+}
+
+/*!
+ * \brief Records an event with the specified \a name without duration.
+ */
+void recordInstant(const char *name)
+{
+    threadBuffer().add(name, now(), -1);
+}
+
+/*!
+ * \brief Writes the recorded events of all threads as Chrome trace JSON to the specified \a path.
+ *
+ * The file can be opened with chrome://tracing or https://ui.perfetto.dev.
+ *
+ * \returns Returns whether the file could be written.
+ */
+bool dumpChromeTrace(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QFile::WriteOnly | QFile::Truncate)) {
+        return false;
+    }
+    QByteArray json("{\"traceEvents\":[\n");
+    auto first = true;
+    const auto appendEvent = [&json, &first](const Event &event, int threadId) {
+        if (!first) {
+            json.append(",\n");
+        }
+        first = false;
+        // names are string literals defined in the code so they don't need to be escaped
+        json.append("{\"name\":\"").append(event.name).append("\",\"pid\":1,\"tid\":").append(QByteArray::number(threadId));
+        json.append(",\"ts\":").append(QByteArray::number(event.begin));
+        if (event.duration >= 0) {
+            json.append(",\"ph\":\"X\",\"dur\":").append(QByteArray::number(event.duration)).append('}');
+        } else {
+            json.append(",\"ph\":\"i\",\"s\":\"t\"}");
+        }
+    };
+
+    std::vector<std::shared_ptr<Buffer>> buffers;
+    {
+        auto &[mutex, registeredBuffers] = registry();
+        const std::lock_guard<std::mutex> lock(mutex);
+        buffers = registeredBuffers;
+    }
+    std::vector<Event> events;
+    for (const auto &buffer : buffers) {
+        const auto end = buffer->written.load(std::memory_order_acquire);
+        const auto begin = end > Buffer::capacity ? end - Buffer::capacity : 0;
+        events.clear();
+        events.reserve(end - begin);
+        for (auto i = begin; i != end; ++i) {
+            events.emplace_back(buffer->events[i % Buffer::capacity]);
+        }
+        // skip events the thread might have overwritten while copying; the slot of the event at index i is reused
+        // by the write at index i + capacity which might still be in progress when written has not been increased yet
+        const auto writtenAfterCopying = buffer->written.load(std::memory_order_acquire);
+        const auto firstIntact = writtenAfterCopying >= Buffer::capacity ? writtenAfterCopying - Buffer::capacity + 1 : 0;
+        const auto skipped = firstIntact > begin ? firstIntact - begin : 0;
+        for (auto i = std::min<std::size_t>(skipped, events.size()); i < events.size(); ++i) {
+            appendEvent(events[i], buffer->threadId);
+        }
+    }
+    json.append("\n]}\n");
+    return file.write(json) == json.size();
+}
+
+} // namespace Tracing
+} // namespace Application
+
+#endif // VIDEODOWNLOADER_TRACING
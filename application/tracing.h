@@ -0,0 +1,79 @@
+#ifndef APPLICATION_TRACING_H
+#define APPLICATION_TRACING_H
+
+/*!
+ * \file tracing.h
+ * \brief Contains macros for recording trace events of the download pipeline.
+ *
+ * The macros expand to nothing unless the project is configured with ENABLE_TRACING so the trace points
+ * do not cost anything in regular builds.
+ */
+
+#ifdef VIDEODOWNLOADER_TRACING
+
+#include <QtGlobal>
+
+QT_FORWARD_DECLARE_CLASS(QString)
+
+namespace Application {
+
+namespace Tracing {
+
+qint64 now();
+void recordComplete(const char *name, qint64 begin, qint64 end);
+void recordInstant(const char *name);
+bool dumpChromeTrace(const QString &path);
+
+/*!
+ * \brief The Scope class records a complete event spanning its lifetime.
+ * \remarks Use the TRACE_SCOPE() macro instead of using this class directly.
+ */
+class Scope {
+public:
+    explicit Scope(const char *name);
+    ~Scope();
+
+private:
+    const char *const m_name;
+    const qint64 m_begin;
+};
+
+/*!
+ * \brief Starts the event with the specified \a name which must be a string literal.
+ */
+inline Scope::Scope(const char *name)
+    : m_name(name)
+    , m_begin(now())
+{
+}
+
+/*!
+ * \brief Ends the event.
+ */
+inline Scope::~Scope()
+{
+    recordComplete(m_name, m_begin, now());
+}
+
+} // namespace Tracing
+} // namespace Application
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+/*!
+ * \brief Records an event with the specified \a name spanning the rest of the current scope.
+ */
+#define TRACE_SCOPE(name) const ::Application::Tracing::Scope TRACE_CONCAT(traceScope, __LINE__)(name)
+/*!
+ * \brief Records an event with the specified \a name without duration.
+ */
+#define TRACE_INSTANT(name) ::Application::Tracing::recordInstant(name)
+
+#else
+
+#define TRACE_SCOPE(name)
+#define TRACE_INSTANT(name)
+
+#endif // VIDEODOWNLOADER_TRACING
+
+#endif // APPLICATION_TRACING_H
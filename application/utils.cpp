@@ -5,42 +5,379 @@
 #include <QJsonObject>
 #include <QJsonParseError>
 #include <QString>
-#include <QTextDocument>
+#include <QStringView>
+
+#include <algorithm>
+#include <iterator>
+#include <string_view>
 
 namespace Application {
 
-int substring(const QString &source, QString &target, int startIndex, const QString &startStr, const QString &endStr)
-{
-    int beg = source.indexOf(startStr, startIndex);
-    if (beg > -1) {
-        beg += startStr.length();
-        int end = source.indexOf(endStr, beg);
-        if (end > -1) {
-            int len = end - beg;
-            if (len > 0) {
-                target = source.mid(beg, len);
-                return beg;
-            } else if (len == 0) {
-                target.clear();
-                return beg;
+namespace HtmlEntities {
+
+/*!
+ * \brief The NamedEntity struct maps the name of an HTML entity to its code point.
+ */
+struct NamedEntity {
+    std::string_view name;
+    char32_t codePoint;
+};
+
+/*!
+ * \brief The named entities of HTML 4 (and "apos"), sorted by name.
+ */
+constexpr NamedEntity namedEntities[] = {
+    { "AElig", 0x00C6 }, { "Aacute", 0x00C1 }, { "Acirc", 0x00C2 }, { "Agrave", 0x00C0 }, { "Alpha", 0x0391 }, { "Aring", 0x00C5 },
+    { "Atilde", 0x00C3 }, { "Auml", 0x00C4 }, { "Beta", 0x0392 }, { "Ccedil", 0x00C7 }, { "Chi", 0x03A7 }, { "Dagger", 0x2021 },
+    { "Delta", 0x0394 }, { "ETH", 0x00D0 }, { "Eacute", 0x00C9 }, { "Ecirc", 0x00CA }, { "Egrave", 0x00C8 }, { "Epsilon", 0x0395 },
+    { "Eta", 0x0397 }, { "Euml", 0x00CB }, { "Gamma", 0x0393 }, { "Iacute", 0x00CD }, { "Icirc", 0x00CE }, { "Igrave", 0x00CC }, { "Iota", 0x0399 },
+    { "Iuml", 0x00CF }, { "Kappa", 0x039A }, { "Lambda", 0x039B }, { "Mu", 0x039C }, { "Ntilde", 0x00D1 }, { "Nu", 0x039D }, { "OElig", 0x0152 },
+    { "Oacute", 0x00D3 }, { "Ocirc", 0x00D4 }, { "Ograve", 0x00D2 }, { "Omega", 0x03A9 }, { "Omicron", 0x039F }, { "Oslash", 0x00D8 },
+    { "Otilde", 0x00D5 }, { "Ouml", 0x00D6 }, { "Phi", 0x03A6 }, { "Pi", 0x03A0 }, { "Prime", 0x2033 }, { "Psi", 0x03A8 }, { "Rho", 0x03A1 },
+    { "Scaron", 0x0160 }, { "Sigma", 0x03A3 }, { "THORN", 0x00DE }, { "Tau", 0x03A4 }, { "Theta", 0x0398 }, { "Uacute", 0x00DA },
+    { "Ucirc", 0x00DB }, { "Ugrave", 0x00D9 }, { "Upsilon", 0x03A5 }, { "Uuml", 0x00DC }, { "Xi", 0x039E }, { "Yacute", 0x00DD },
+    { "Yuml", 0x0178 }, { "Zeta", 0x0396 }, { "aacute", 0x00E1 }, { "acirc", 0x00E2 }, { "acute", 0x00B4 }, { "aelig", 0x00E6 },
+    { "agrave", 0x00E0 }, { "alefsym", 0x2135 }, { "alpha", 0x03B1 }, { "amp", 0x0026 }, { "and", 0x2227 }, { "ang", 0x2220 }, { "apos", 0x0027 },
+    { "aring", 0x00E5 }, { "asymp", 0x2248 }, { "atilde", 0x00E3 }, { "auml", 0x00E4 }, { "bdquo", 0x201E }, { "beta", 0x03B2 },
+    { "brvbar", 0x00A6 }, { "bull", 0x2022 }, { "cap", 0x2229 }, { "ccedil", 0x00E7 }, { "cedil", 0x00B8 }, { "cent", 0x00A2 }, { "chi", 0x03C7 },
+    { "circ", 0x02C6 }, { "clubs", 0x2663 }, { "cong", 0x2245 }, { "copy", 0x00A9 }, { "crarr", 0x21B5 }, { "cup", 0x222A }, { "curren", 0x00A4 },
+    { "dArr", 0x21D3 }, { "dagger", 0x2020 }, { "darr", 0x2193 }, { "deg", 0x00B0 }, { "delta", 0x03B4 }, { "diams", 0x2666 }, { "divide", 0x00F7 },
+    { "eacute", 0x00E9 }, { "ecirc", 0x00EA }, { "egrave", 0x00E8 }, { "empty", 0x2205 }, { "emsp", 0x2003 }, { "ensp", 0x2002 },
+    { "epsilon", 0x03B5 }, { "equiv", 0x2261 }, { "eta", 0x03B7 }, { "eth", 0x00F0 }, { "euml", 0x00EB }, { "euro", 0x20AC }, { "exist", 0x2203 },
+    { "fnof", 0x0192 }, { "forall", 0x2200 }, { "frac12", 0x00BD }, { "frac14", 0x00BC }, { "frac34", 0x00BE }, { "frasl", 0x2044 },
+    { "gamma", 0x03B3 }, { "ge", 0x2265 }, { "gt", 0x003E }, { "hArr", 0x21D4 }, { "harr", 0x2194 }, { "hearts", 0x2665 }, { "hellip", 0x2026 },
+    { "iacute", 0x00ED }, { "icirc", 0x00EE }, { "iexcl", 0x00A1 }, { "igrave", 0x00EC }, { "image", 0x2111 }, { "infin", 0x221E },
+    { "int", 0x222B }, { "iota", 0x03B9 }, { "iquest", 0x00BF }, { "isin", 0x2208 }, { "iuml", 0x00EF }, { "kappa", 0x03BA }, { "lArr", 0x21D0 },
+    { "lambda", 0x03BB }, { "lang", 0x2329 }, { "laquo", 0x00AB }, { "larr", 0x2190 }, { "lceil", 0x2308 }, { "ldquo", 0x201C }, { "le", 0x2264 },
+    { "lfloor", 0x230A }, { "lowast", 0x2217 }, { "loz", 0x25CA }, { "lrm", 0x200E }, { "lsaquo", 0x2039 }, { "lsquo", 0x2018 }, { "lt", 0x003C },
+    { "macr", 0x00AF }, { "mdash", 0x2014 }, { "micro", 0x00B5 }, { "middot", 0x00B7 }, { "minus", 0x2212 }, { "mu", 0x03BC }, { "nabla", 0x2207 },
+    { "nbsp", 0x00A0 }, { "ndash", 0x2013 }, { "ne", 0x2260 }, { "ni", 0x220B }, { "not", 0x00AC }, { "notin", 0x2209 }, { "nsub", 0x2284 },
+    { "ntilde", 0x00F1 }, { "nu", 0x03BD }, { "oacute", 0x00F3 }, { "ocirc", 0x00F4 }, { "oelig", 0x0153 }, { "ograve", 0x00F2 },
+    { "oline", 0x203E }, { "omega", 0x03C9 }, { "omicron", 0x03BF }, { "oplus", 0x2295 }, { "or", 0x2228 }, { "ordf", 0x00AA }, { "ordm", 0x00BA },
+    { "oslash", 0x00F8 }, { "otilde", 0x00F5 }, { "otimes", 0x2297 }, { "ouml", 0x00F6 }, { "para", 0x00B6 }, { "part", 0x2202 },
+    { "permil", 0x2030 }, { "perp", 0x22A5 }, { "phi", 0x03C6 }, { "pi", 0x03C0 }, { "piv", 0x03D6 }, { "plusmn", 0x00B1 }, { "pound", 0x00A3 },
+    { "prime", 0x2032 }, { "prod", 0x220F }, { "prop", 0x221D }, { "psi", 0x03C8 }, { "quot", 0x0022 }, { "rArr", 0x21D2 }, { "radic", 0x221A },
+    { "rang", 0x232A }, { "raquo", 0x00BB }, { "rarr", 0x2192 }, { "rceil", 0x2309 }, { "rdquo", 0x201D }, { "real", 0x211C }, { "reg", 0x00AE },
+    { "rfloor", 0x230B }, { "rho", 0x03C1 }, { "rlm", 0x200F }, { "rsaquo", 0x203A }, { "rsquo", 0x2019 }, { "sbquo", 0x201A },
+    { "scaron", 0x0161 }, { "sdot", 0x22C5 }, { "sect", 0x00A7 }, { "shy", 0x00AD }, { "sigma", 0x03C3 }, { "sigmaf", 0x03C2 }, { "sim", 0x223C },
+    { "spades", 0x2660 }, { "sub", 0x2282 }, { "sube", 0x2286 }, { "sum", 0x2211 }, { "sup", 0x2283 }, { "sup1", 0x00B9 }, { "sup2", 0x00B2 },
+    { "sup3", 0x00B3 }, { "supe", 0x2287 }, { "szlig", 0x00DF }, { "tau", 0x03C4 }, { "there4", 0x2234 }, { "theta", 0x03B8 },
+    { "thetasym", 0x03D1 }, { "thinsp", 0x2009 }, { "thorn", 0x00FE }, { "tilde", 0x02DC }, { "times", 0x00D7 }, { "trade", 0x2122 },
+    { "uArr", 0x21D1 }, { "uacute", 0x00FA }, { "uarr", 0x2191 }, { "ucirc", 0x00FB }, { "ugrave", 0x00F9 }, { "uml", 0x00A8 }, { "upsih", 0x03D2 },
+    { "upsilon", 0x03C5 }, { "uuml", 0x00FC }, { "weierp", 0x2118 }, { "xi", 0x03BE }, { "yacute", 0x00FD }, { "yen", 0x00A5 }, { "yuml", 0x00FF },
+    { "zeta", 0x03B6 }, { "zwj", 0x200D }, { "zwnj", 0x200C },
+};
+constexpr std::size_t maxNameLength = 8;
+
+/*!
+ * \brief Returns whether the named entities are sorted so they can be looked up via binary search.
+ */
+constexpr bool areSorted()
+{
+    for (std::size_t i = 1; i < std::size(namedEntities); ++i) {
+        if (!(namedEntities[i - 1].name < namedEntities[i].name)) {
+            return false;
+        }
+    }
+    return true;
+}
+static_assert(areSorted(), "named entities must be sorted by name");
+
+/*!
+ * \brief Returns the code point of the entity with the specified \a name or zero if there's no such entity.
+ */
+static char32_t lookup(QStringView name)
+{
+    if (name.size() > static_cast<qsizetype>(maxNameLength)) {
+        return 0;
+    }
+    char buffer[maxNameLength];
+    for (qsizetype i = 0; i != name.size(); ++i) {
+        buffer[i] = static_cast<char>(name[i].unicode());
+    }
+    const auto key = std::string_view(buffer, static_cast<std::size_t>(name.size()));
+    const auto entity = std::lower_bound(std::begin(namedEntities), std::end(namedEntities), key,
+        [](const NamedEntity &entity, std::string_view key) { return entity.name < key; });
+    return entity != std::end(namedEntities) && entity->name == key ? entity->codePoint : 0;
+}
+
+/*!
+ * \brief Returns whether \a c is considered whitespace by HTML.
+ */
+static bool isSpace(QChar c)
+{
+    return c == QLatin1Char(' ') || c == QLatin1Char('\t') || c == QLatin1Char('\n') || c == QLatin1Char('\r') || c == QLatin1Char('\f');
+}
+
+/*!
+ * \brief Returns whether \a text contains only whitespace (in the sense of QChar::isSpace()).
+ */
+static bool isWhitespaceOnly(QStringView text)
+{
+    return std::all_of(text.begin(), text.end(), [](QChar c) { return c.isSpace(); });
+}
+
+/*!
+ * \brief Returns whether \a text contains whitespace which would be collapsed or trimmed.
+ */
+static bool needsWhitespaceNormalization(QStringView text)
+{
+    auto previousWasSpace = true; // leading whitespace is trimmed
+    for (const QChar c : text) {
+        if (c == QLatin1Char(' ')) {
+            if (previousWasSpace) {
+                return true;
             }
+            previousWasSpace = true;
+        } else if (isSpace(c)) {
+            return true;
+        } else {
+            previousWasSpace = false;
         }
     }
-    return -1;
+    return previousWasSpace && !text.isEmpty(); // trailing whitespace is trimmed
+}
+
+/*!
+ * \brief The Writer class composes the plain text; it collapses whitespace and line breaks like QTextDocument does.
+ */
+class Writer {
+public:
+    explicit Writer(qsizetype capacity);
+    void appendText(QChar c);
+    void appendCodePoint(char32_t codePoint);
+    void appendSpace();
+    void appendLineBreak();
+    void appendBlockBreak();
+    QString &text();
+
+private:
+    QString m_text;
+    bool m_pendingSpace;
+    bool m_pendingBlockBreak;
+};
+
+Writer::Writer(qsizetype capacity)
+    : m_pendingSpace(false)
+    , m_pendingBlockBreak(false)
+{
+    m_text.reserve(capacity);
+}
+
+void Writer::appendText(QChar c)
+{
+    if (!m_text.isEmpty()) {
+        if (m_pendingBlockBreak && !m_text.endsWith(QLatin1Char('\n'))) {
+            m_text += QLatin1Char('\n');
+        } else if (m_pendingSpace && !m_pendingBlockBreak && !m_text.endsWith(QLatin1Char('\n'))) {
+            m_text += QLatin1Char(' ');
+        }
+    }
+    m_pendingSpace = m_pendingBlockBreak = false;
+    m_text += c;
+}
+
+void Writer::appendCodePoint(char32_t codePoint)
+{
+    if (codePoint == 0xA0) {
+        appendText(QLatin1Char(' ')); // like QTextDocument::toPlainText()
+    } else if (QChar::requiresSurrogates(codePoint)) {
+        appendText(QChar(QChar::highSurrogate(codePoint)));
+        m_text += QChar(QChar::lowSurrogate(codePoint));
+    } else {
+        appendText(QChar(static_cast<char16_t>(codePoint)));
+    }
+}
+
+void Writer::appendSpace()
+{
+    m_pendingSpace = true;
+}
+
+void Writer::appendLineBreak()
+{
+    m_pendingSpace = m_pendingBlockBreak = false;
+    m_text += QLatin1Char('\n');
 }
 
+void Writer::appendBlockBreak()
+{
+    m_pendingBlockBreak = true;
+}
+
+QString &Writer::text()
+{
+    return m_text;
+}
+
+/*!
+ * \brief Decodes the entity starting at \a i (which points to the '&'); advances \a i on success.
+ * \returns Returns the code point or zero if there's no valid entity.
+ */
+static char32_t decodeEntity(QStringView text, qsizetype &i)
+{
+    auto end = i + 1;
+    char32_t codePoint = 0;
+    if (end < text.size() && text[end] == QLatin1Char('#')) {
+        // numeric entity, the semicolon is optional
+        ++end;
+        const auto hex = end < text.size() && (text[end] == QLatin1Char('x') || text[end] == QLatin1Char('X'));
+        if (hex) {
+            ++end;
+        }
+        const auto digitsBegin = end;
+        // skip leading zeros so they don't count towards the limit of significant digits which prevents overflows
+        while (end < text.size() && text[end] == QLatin1Char('0')) {
+            ++end;
+        }
+        for (const auto significantDigitsBegin = end; end < text.size() && end - significantDigitsBegin < 8; ++end) {
+            const auto c = text[end].unicode();
+            int digit;
+            if (c >= '0' && c <= '9') {
+                digit = c - '0';
+            } else if (hex && c >= 'a' && c <= 'f') {
+                digit = c - 'a' + 10;
+            } else if (hex && c >= 'A' && c <= 'F') {
+                digit = c - 'A' + 10;
+            } else {
+                break;
+            }
+            codePoint = codePoint * (hex ? 16 : 10) + static_cast<char32_t>(digit);
+        }
+        if (end == digitsBegin || !codePoint || codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF)) {
+            return 0;
+        }
+    } else {
+        // named entity, the semicolon is required
+        for (; end < text.size() && end - i <= static_cast<qsizetype>(maxNameLength); ++end) {
+            const auto c = text[end].unicode();
+            if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9'))) {
+                break;
+            }
+        }
+        if (end >= text.size() || text[end] != QLatin1Char(';') || !(codePoint = lookup(text.mid(i + 1, end - i - 1)))) {
+            return 0;
+        }
+    }
+    i = end < text.size() && text[end] == QLatin1Char(';') ? end + 1 : end;
+    return codePoint;
+}
+
+/*!
+ * \brief Returns whether the tag with the specified \a name starts a new block.
+ */
+static bool isBlockTag(QStringView name)
+{
+    static constexpr std::string_view blockTags[]
+        = { "blockquote", "dd", "div", "dl", "dt", "h1", "h2", "h3", "h4", "h5", "h6", "hr", "li", "ol", "p", "pre", "table", "tr", "ul" };
+    for (const auto tag : blockTags) {
+        if (name.compare(QLatin1String(tag.data(), static_cast<qsizetype>(tag.size())), Qt::CaseInsensitive) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*!
+ * \brief Handles the markup starting at \a i (which points to the '<'); advances \a i on success.
+ * \returns Returns whether there was markup at all; otherwise the '<' is meant literally.
+ */
+static bool skipMarkup(QStringView text, qsizetype &i, Writer &writer)
+{
+    if (text.mid(i, 4) == QLatin1String("<!--")) {
+        const auto end = text.indexOf(QLatin1String("-->"), i + 4);
+        i = end < 0 ? text.size() : end + 3;
+        return true;
+    }
+    const auto nameBegin = i + 1 + (i + 1 < text.size() && (text[i + 1] == QLatin1Char('/')));
+    if (nameBegin >= text.size() || !(text[nameBegin].isLetter() || text[nameBegin] == QLatin1Char('!') || text[nameBegin] == QLatin1Char('?'))) {
+        return false;
+    }
+    const auto end = text.indexOf(QLatin1Char('>'), nameBegin);
+    if (end < 0) {
+        return false;
+    }
+    auto nameEnd = nameBegin;
+    while (nameEnd < end && text[nameEnd].isLetterOrNumber()) {
+        ++nameEnd;
+    }
+    const auto name = text.mid(nameBegin, nameEnd - nameBegin);
+    const auto closing = nameBegin != i + 1;
+    i = end + 1;
+    if (name.compare(QLatin1String("br"), Qt::CaseInsensitive) == 0) {
+        writer.appendLineBreak();
+    } else if (isBlockTag(name)) {
+        writer.appendBlockBreak();
+    } else if (!closing
+        && (name.compare(QLatin1String("script"), Qt::CaseInsensitive) == 0 || name.compare(QLatin1String("style"), Qt::CaseInsensitive) == 0)) {
+        // skip the contents as well
+        const auto closingTag = text.indexOf(QStringLiteral("</") + name.toString(), i, Qt::CaseInsensitive);
+        const auto closingEnd = closingTag < 0 ? -1 : text.indexOf(QLatin1Char('>'), closingTag);
+        i = closingEnd < 0 ? text.size() : closingEnd + 1;
+    }
+    return true;
+}
+
+} // namespace HtmlEntities
+
+/*!
+ * \brief Returns whether \a value equals the specified \a lowerCaseValue ignoring the case of ASCII letters.
+ */
+bool equalsIgnoringCase(std::string_view value, std::string_view lowerCaseValue)
+{
+    return value.size() == lowerCaseValue.size()
+        && std::equal(value.begin(), value.end(), lowerCaseValue.begin(),
+            [](char c, char lowerCaseChar) { return (c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c) == lowerCaseChar; });
+}
+
+/*!
+ * \brief Converts the specified HTML \a text to plain text.
+ *
+ * Entities (named entities of HTML 4 and numeric entities) are decoded, tags are removed and whitespace is
+ * collapsed. Line breaks and blocks are converted to new lines. The text is cleared if it contains only
+ * whitespace. This gives the same result as QTextDocument::setHtml() followed by QTextDocument::toPlainText()
+ * for the snippets of HTML passed here (titles, names and URLs) but is a lot cheaper.
+ *
+ * Texts without markup, entities and superfluous whitespace are returned without being copied.
+ */
 void replaceHtmlEntities(QString &text)
 {
-    //text = text.replace("&amp;", "&").replace("&gt;", ">").replace("&lt;" ,"<").replace("&#39;", "'");
-    QTextDocument textDocument;
-    textDocument.setHtml(text);
-    text = textDocument.toPlainText();
-    for (const QChar &c : text) {
-        if (!c.isSpace()) {
-            return;
+    using namespace HtmlEntities;
+    const auto ampersand = text.indexOf(QLatin1Char('&'));
+    const auto lessThan = ampersand < 0 ? text.indexOf(QLatin1Char('<')) : -1;
+    if (ampersand < 0 && lessThan < 0 && !needsWhitespaceNormalization(text)) {
+        if (!text.isEmpty() && text.front().isSpace() && isWhitespaceOnly(text)) {
+            text.clear();
+        }
+        return;
+    }
+
+    const auto view = QStringView(text);
+    Writer writer(text.size());
+    for (qsizetype i = 0, size = view.size(); i < size;) {
+        const auto c = view[i];
+        if (c == QLatin1Char('&')) {
+            if (const auto codePoint = decodeEntity(view, i)) {
+                writer.appendCodePoint(codePoint);
+                continue;
+            }
+        } else if (c == QLatin1Char('<')) {
+            if (skipMarkup(view, i, writer)) {
+                continue;
+            }
+        } else if (isSpace(c)) {
+            writer.appendSpace();
+            ++i;
+            continue;
         }
+        writer.appendText(c);
+        ++i;
+    }
+    text = std::move(writer.text());
+    // clear the text if it contains only whitespace, eg. "&nbsp;", like before
+    if (isWhitespaceOnly(text)) {
+        text.clear();
     }
-    text.clear(); // clear text if it contains white spaces only
 }
 
 QJsonObject loadJsonObjectFromResource(const QString &resource, QString *error)
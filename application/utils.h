@@ -3,9 +3,11 @@
 
 #include <QJsonObject>
 
+#include <string_view>
+
 namespace Application {
 
-int substring(const QString &source, QString &target, int startIndex, const QString &startStr, const QString &endStr);
+bool equalsIgnoringCase(std::string_view value, std::string_view lowerCaseValue);
 void replaceHtmlEntities(QString &text);
 QJsonObject loadJsonObjectFromResource(const QString &resource, QString *error = nullptr);
 } // namespace Application
@@ -109,11 +109,7 @@ void download(int argc, char *argv[], const ArgumentOccurrence &, const Argument
         if (!noConfirmArg.isPresent() && !confirmPrompt("Do you want to start these downloads?", Response::Yes)) {
             return;
         }
-        cout << "Starting downloads ..." << endl;
-        //for(Download *download : downloads) {
-        //    download->init();
-        //}
-        cout << "TODO" << endl;
+        cerr << "Running downloads from the command line is not supported yet; use the GUI instead." << endl;
     }
 }
 } // namespace Cli
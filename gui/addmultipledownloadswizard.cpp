@@ -16,6 +16,7 @@
 #include <QCommandLinkButton>
 #include <QHeaderView>
 #include <QScrollBar>
+#include <QSpinBox>
 #include <QTreeView>
 #include <QVBoxLayout>
 
@@ -81,16 +82,30 @@ AddMultipleDownloadsEnterSearchTermPage::AddMultipleDownloadsEnterSearchTermPage
     // create check boxes
     m_byIdCheckBox = new QCheckBox(tr("search by ID"), this);
     m_verifiedOnlyCheckBox = new QCheckBox(tr("show only verified songs if possible"), nullptr);
+    m_crawlBelowUrlOnlyCheckBox = new QCheckBox(tr("only follow links to pages below the URL"), this);
+    // create spin box
+    m_crawlDepthSpinBox = new QSpinBox(this);
+    m_crawlDepthSpinBox->setRange(0, 20);
+    m_crawlDepthSpinBox->setPrefix(tr("follow links to further pages up to depth "));
+    m_crawlDepthSpinBox->setSpecialValueText(tr("don't follow links to further pages"));
+    connect(m_crawlDepthSpinBox, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), m_crawlBelowUrlOnlyCheckBox,
+        [this](int depth) { m_crawlBelowUrlOnlyCheckBox->setEnabled(depth > 0); });
+    m_crawlBelowUrlOnlyCheckBox->setEnabled(false);
+    m_crawlBelowUrlOnlyCheckBox->setChecked(true);
     // add layout
     QVBoxLayout *layout = new QVBoxLayout(this);
     layout->addWidget(m_searchTermLineEdit);
     layout->addWidget(m_byIdCheckBox);
     layout->addWidget(m_verifiedOnlyCheckBox);
+    layout->addWidget(m_crawlDepthSpinBox);
+    layout->addWidget(m_crawlBelowUrlOnlyCheckBox);
     setLayout(layout);
     // register fields
     registerField(QStringLiteral("term*"), m_searchTermLineEdit);
     registerField(QStringLiteral("byid"), m_byIdCheckBox);
     registerField(QStringLiteral("verifiedonly"), m_verifiedOnlyCheckBox);
+    registerField(QStringLiteral("crawldepth"), m_crawlDepthSpinBox);
+    registerField(QStringLiteral("crawlbelowurlonly"), m_crawlBelowUrlOnlyCheckBox);
 }
 
 QString AddMultipleDownloadsEnterSearchTermPage::searchTerm() const
@@ -112,6 +127,8 @@ void AddMultipleDownloadsEnterSearchTermPage::initializePage()
         m_searchTermLineEdit->setPlaceholderText(QStringLiteral("URL"));
         m_byIdCheckBox->setHidden(true);
         m_verifiedOnlyCheckBox->setHidden(true);
+        m_crawlDepthSpinBox->setHidden(false);
+        m_crawlBelowUrlOnlyCheckBox->setHidden(false);
         break;
     case DownloadSource::YoutubePlaylist:
         setTitle(tr("Specify YouTube playlist"));
@@ -120,6 +137,8 @@ void AddMultipleDownloadsEnterSearchTermPage::initializePage()
         m_searchTermLineEdit->setPlaceholderText(QStringLiteral("URL"));
         m_byIdCheckBox->setHidden(false);
         m_verifiedOnlyCheckBox->setHidden(true);
+        m_crawlDepthSpinBox->setHidden(true);
+        m_crawlBelowUrlOnlyCheckBox->setHidden(true);
         break;
     case DownloadSource::GroovesharkAlbum:
         setTitle(tr("Specify Grooveshark album"));
@@ -128,6 +147,8 @@ void AddMultipleDownloadsEnterSearchTermPage::initializePage()
         m_searchTermLineEdit->setPlaceholderText(tr("search term or ID"));
         m_byIdCheckBox->setHidden(false);
         m_verifiedOnlyCheckBox->setHidden(false);
+        m_crawlDepthSpinBox->setHidden(true);
+        m_crawlBelowUrlOnlyCheckBox->setHidden(true);
         break;
     case DownloadSource::GroovesharkPlaylist:
         setTitle(tr("Specify Grooveshark playlist"));
@@ -136,6 +157,8 @@ void AddMultipleDownloadsEnterSearchTermPage::initializePage()
         m_searchTermLineEdit->setPlaceholderText(tr("search term or ID"));
         m_byIdCheckBox->setHidden(false);
         m_verifiedOnlyCheckBox->setHidden(false);
+        m_crawlDepthSpinBox->setHidden(true);
+        m_crawlBelowUrlOnlyCheckBox->setHidden(true);
         break;
     default:
         setTitle(tr("No source selected"));
@@ -143,6 +166,8 @@ void AddMultipleDownloadsEnterSearchTermPage::initializePage()
         setEnabled(false);
         m_byIdCheckBox->setHidden(true);
         m_verifiedOnlyCheckBox->setHidden(true);
+        m_crawlDepthSpinBox->setHidden(true);
+        m_crawlBelowUrlOnlyCheckBox->setHidden(true);
     }
 }
 
@@ -186,12 +211,16 @@ void AddMultipleDownloadsResultsPage::initializePage()
     QString term = field(QStringLiteral("term")).toString();
     bool verifiedOnly = field(QStringLiteral("verfiedonly")).toBool();
     switch (source) {
-    case DownloadSource::WebpageLinks:
+    case DownloadSource::WebpageLinks: {
         setTitle(tr("Select links to be added"));
         m_collectionKind = tr("Webpage");
         m_collectionContent = tr("links");
-        m_finder = new LinkFinder(QUrl(term), this);
+        auto *const linkFinder = new LinkFinder(QUrl(term), this);
+        linkFinder->setCrawlDepth(field(QStringLiteral("crawldepth")).toInt());
+        linkFinder->setCrawlScope(field(QStringLiteral("crawlbelowurlonly")).toBool() ? CrawlScope::Prefix : CrawlScope::SameHost);
+        m_finder = linkFinder;
         break;
+    }
     case DownloadSource::YoutubePlaylist:
         setTitle(tr("Select videos to be added"));
         m_collectionKind = tr("YouTube playlist");
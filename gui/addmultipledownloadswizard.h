@@ -6,6 +6,7 @@
 #include <QWizardPage>
 
 QT_FORWARD_DECLARE_CLASS(QCheckBox)
+QT_FORWARD_DECLARE_CLASS(QSpinBox)
 QT_FORWARD_DECLARE_CLASS(QTreeView)
 QT_FORWARD_DECLARE_CLASS(QItemSelection)
 
@@ -66,6 +67,8 @@ private:
     QtUtilities::ClearLineEdit *m_searchTermLineEdit;
     QCheckBox *m_byIdCheckBox;
     QCheckBox *m_verifiedOnlyCheckBox;
+    QSpinBox *m_crawlDepthSpinBox;
+    QCheckBox *m_crawlBelowUrlOnlyCheckBox;
 };
 
 class AddMultipleDownloadsResultsPage : public QWizardPage {
@@ -7,7 +7,10 @@
 
 #include "../network/bitsharedownload.h"
 #include "../network/download.h"
+#include "../network/downloadscheduler.h"
 #include "../network/groovesharkdownload.h"
+#include "../network/httpdownload.h"
+#include "../network/misc/metricsexporter.h"
 #include "../network/socksharedownload.h"
 #include "../network/youtubedownload.h"
 #ifdef CONFIG_TESTDOWNLOAD
@@ -16,6 +19,8 @@
 
 #include "../model/downloadmodel.h"
 
+#include "../application/tracing.h"
+
 #include "../itemdelegates/comboboxitemdelegate.h"
 #include "../itemdelegates/progressbaritemdelegate.h"
 
@@ -38,6 +43,9 @@
 #include <QFileDialog>
 #include <QFileSystemModel>
 #include <QInputDialog>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QLabel>
 #include <QList>
 #include <QMessageBox>
@@ -48,6 +56,7 @@
 #include <QTimer>
 #include <QToolButton>
 
+#include <array>
 #include <functional>
 
 using namespace std;
@@ -64,10 +73,12 @@ MainWindow::MainWindow(QWidget *parent)
     , m_trayIcon(nullptr)
     , m_trayIconMenu(nullptr)
     , m_internalClipboardChange(false)
+    , m_scheduler(new DownloadScheduler(this))
     , m_activeDownloads(0)
     , m_downloadsToStart(0)
     , m_initiatingDownloads(0)
     , m_totalSpeed(0)
+    , m_totalAverageSpeed(0)
     , m_stillToReceive(0)
     , m_downloadInteraction(new DownloadInteraction(this))
     , m_addDownloadDlg(nullptr)
@@ -125,7 +136,10 @@ MainWindow::MainWindow(QWidget *parent)
     m_progressBarDelegate = new ProgressBarItemDelegate(this);
     m_comboBoxDelegate = new ComboBoxItemDelegate(this);
     m_model = new DownloadModel(this);
+    m_scheduler->setPreparator(&applySettingsToDownload);
+    MetricsExporter::instance().setCollector(std::bind(&MainWindow::collectMetrics, this, std::placeholders::_1));
     m_ui->downloadsTreeView->setItemDelegateForColumn(DownloadModel::optionsColumn(), m_comboBoxDelegate);
+    m_ui->downloadsTreeView->setItemDelegateForColumn(DownloadModel::priorityColumn(), m_comboBoxDelegate);
     m_ui->downloadsTreeView->setItemDelegateForColumn(DownloadModel::progressColumn(), m_progressBarDelegate);
     m_ui->downloadsTreeView->setModel(m_model);
     updateSelectionMode();
@@ -136,9 +150,16 @@ MainWindow::MainWindow(QWidget *parent)
     m_downloadsTreeViewContextMenu->addAction(m_ui->actionResume_selected_downloads);
     m_downloadsTreeViewContextMenu->addAction(m_ui->actionRemove_selected_downloads_from_list);
     m_downloadsTreeViewContextMenu->addAction(m_ui->actionCopy_download_url);
+    connect(m_downloadsTreeViewContextMenu->addAction(QIcon::fromTheme(QStringLiteral("edit-copy")), tr("Copy transfer timings")),
+        &QAction::triggered, this, &MainWindow::copyTransferTimings);
     m_downloadsTreeViewContextMenu->addAction(m_ui->actionSet_range);
     m_downloadsTreeViewContextMenu->addAction(m_ui->actionSet_target);
     m_downloadsTreeViewContextMenu->addAction(m_ui->actionClear_target);
+    QMenu *priorityMenu = m_downloadsTreeViewContextMenu->addMenu(tr("Set priority"));
+    for (const DownloadPriority priority : { DownloadPriority::Urgent, DownloadPriority::Normal, DownloadPriority::Background }) {
+        connect(priorityMenu->addAction(DownloadModel::priorityName(priority)), &QAction::triggered, this,
+            std::bind(&MainWindow::setPriorityOfSelectedDownloads, this, priority));
+    }
     m_ui->downloadsTreeView->setContextMenuPolicy(Qt::CustomContextMenu);
     connect(m_ui->downloadsTreeView, &QTreeView::customContextMenuRequested, this, &MainWindow::showDownloadsTreeViewContextMenu);
     // column widths
@@ -181,14 +202,20 @@ MainWindow::MainWindow(QWidget *parent)
     // ?
     connect(m_ui->actionAbout, &QAction::triggered, this, &MainWindow::showAboutDialog);
     connect(m_ui->actionYoutube_itags, &QAction::triggered, this, &MainWindow::showYoutubeItagsInfo);
+#ifdef VIDEODOWNLOADER_TRACING
+    connect(m_ui->menu->addAction(QIcon::fromTheme(QStringLiteral("document-save")), tr("Save trace ...")), &QAction::triggered, this,
+        &MainWindow::saveTrace);
+#endif
     // other
-    connect(m_autoSpinBox, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, &MainWindow::checkForDownloadsToStartAutomatically);
+    connect(m_autoSpinBox, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), m_scheduler,
+        &DownloadScheduler::setMaxConcurrentDownloads);
     connect(m_ui->actionExplore_target_directory, &QAction::triggered, this, &MainWindow::exploreDownloadsDir);
     connect(QApplication::clipboard(), &QClipboard::dataChanged, this, &MainWindow::clipboardDataChanged);
 }
 
 MainWindow::~MainWindow()
 {
+    MetricsExporter::instance().setCollector(MetricsExporter::Collector());
 }
 
 // Methods to show several dialogs
@@ -217,8 +244,9 @@ void MainWindow::addDownload(Download *download)
     connect(download, &Download::statusChanged, this, &MainWindow::downloadChangedStatus);
     connect(download, &Download::progressChanged, this, &MainWindow::downloadChangedProgress);
     m_downloadInteraction->connectDownload(download);
-    // add download to model
+    // add download to model and scheduler
     m_model->addDownload(download);
+    m_scheduler->addDownload(download);
     // Begin to fetch initial info
     if (!download->isInitiated() && download->isInitiatingInstantlyRecommendable()) {
         applySettingsToDownload(download);
@@ -303,27 +331,6 @@ void MainWindow::showTrayIconMessage()
            "choose \"Quit\" in the context menu of the system tray entry."));
 }
 
-void MainWindow::checkForDownloadsToStartAutomatically()
-{
-    for (int row = 0, rowCount = m_model->rowCount(), toStart = m_autoSpinBox->value() - m_activeDownloads - m_initiatingDownloads;
-         row < rowCount && toStart > 0; ++row) {
-        Download *download = m_model->download(row);
-        switch (download->status()) {
-        case DownloadStatus::None:
-            applySettingsToDownload(download);
-            download->init();
-            --toStart;
-            break;
-        case DownloadStatus::Ready:
-            applySettingsToDownload(download);
-            download->start();
-            --toStart;
-            break;
-        default:;
-        }
-    }
-}
-
 // Methods to start and stop downloads
 void MainWindow::startOrStopSelectedDownloads()
 {
@@ -432,13 +439,10 @@ void MainWindow::interruptOrResumeSelectedDownloads()
 
 void MainWindow::removeSelectedDownloads()
 {
-    int removed = 0;
-    QModelIndexList selectedIndexes = m_ui->downloadsTreeView->selectionModel()->selectedRows();
-    QList<QPersistentModelIndex> persistendIndexes;
+    const QModelIndexList selectedIndexes = m_ui->downloadsTreeView->selectionModel()->selectedRows();
+    QList<Download *> downloadsToRemove;
+    downloadsToRemove.reserve(selectedIndexes.size());
     for (const QModelIndex &selectedIndex : selectedIndexes) {
-        persistendIndexes << QPersistentModelIndex(selectedIndex);
-    }
-    for (const QPersistentModelIndex &selectedIndex : persistendIndexes) {
         if (Download *download = m_model->download(selectedIndex)) {
             switch (download->status()) {
             case DownloadStatus::Downloading:
@@ -446,14 +450,16 @@ void MainWindow::removeSelectedDownloads()
             case DownloadStatus::FinishOuputFile:
                 break;
             default:
-                m_model->removeDownload(download);
-                delete download;
-                --m_downloadsToStart;
-                ++removed;
+                downloadsToRemove << download;
                 break;
             }
         }
     }
+    // remove all downloads from the model at once before deleting them
+    m_model->removeDownloads(downloadsToRemove);
+    qDeleteAll(downloadsToRemove);
+    const int removed = static_cast<int>(downloadsToRemove.size());
+    m_downloadsToStart -= removed;
     if (removed == 1) {
         m_downloadStatusLabel->setText(tr("the download has been removed"));
     } else if (removed > 1) {
@@ -704,6 +710,94 @@ void MainWindow::copyDownloadUrl()
     m_internalClipboardChange = false;
 }
 
+/*!
+ * \brief Copies the transfer timings of the selected downloads as JSON array to the clipboard.
+ */
+void MainWindow::copyTransferTimings()
+{
+    const QList<Download *> downloads = selectedDownloads();
+    if (downloads.isEmpty()) {
+        QMessageBox::warning(this, windowTitle(), tr("There are no downloads selected."));
+        return;
+    }
+    QJsonArray timings;
+    for (Download *download : downloads) {
+        QJsonObject downloadTimings;
+        downloadTimings.insert(QStringLiteral("url"), download->initialUrl().toString());
+        downloadTimings.insert(QStringLiteral("downloadUrl"), download->downloadUrl().toString());
+        if (download->isValidOptionChosen()) {
+            downloadTimings.insert(QStringLiteral("option"), download->chosenOptionName());
+            downloadTimings.insert(QStringLiteral("timings"), download->options().at(download->chosenOption()).transferTimings().toJson());
+        }
+        timings.append(downloadTimings);
+    }
+    m_internalClipboardChange = true;
+    QApplication::clipboard()->setText(QString::fromUtf8(QJsonDocument(timings).toJson()));
+    m_internalClipboardChange = false;
+}
+
+#ifdef VIDEODOWNLOADER_TRACING
+/*!
+ * \brief Saves the recorded trace events as Chrome trace JSON to a file selected by the user.
+ */
+void MainWindow::saveTrace()
+{
+    const QString path = QFileDialog::getSaveFileName(this, tr("Save trace"), QString(), tr("Chrome trace (*.json)"));
+    if (!path.isEmpty() && !Application::Tracing::dumpChromeTrace(path)) {
+        QMessageBox::warning(this, windowTitle(), tr("Unable to write the trace to \"%1\".").arg(path));
+    }
+}
+#endif
+
+/*!
+ * \brief Writes the metrics served by the MetricsExporter.
+ */
+void MainWindow::collectMetrics(MetricsWriter &writer) const
+{
+    static const char *const statusNames[] = { "none", "initiating", "waiting", "ready", "downloading", "finishing", "interrupting",
+        "aborting", "interrupted", "failed", "finished" };
+    std::array<int, sizeof(statusNames) / sizeof(*statusNames)> downloadsPerStatus{};
+    qint64 readBufferSize = 0, bufferedBytes = 0;
+    for (int row = 0, rowCount = m_model->rowCount(); row != rowCount; ++row) {
+        const Download *const download = m_model->download(row);
+        ++downloadsPerStatus[static_cast<std::size_t>(download->status())];
+        for (const OptionData &optionData : download->options()) {
+            if (download->status() == DownloadStatus::Downloading) {
+                readBufferSize += optionData.readBufferSize();
+            }
+            bufferedBytes += optionData.bufferedBytes();
+        }
+    }
+    writer.addMetric("videodownloader_downloads", "gauge", "Number of downloads in the list by status.");
+    for (std::size_t i = 0; i != downloadsPerStatus.size(); ++i) {
+        writer.addSample("videodownloader_downloads", "status", QString::fromLatin1(statusNames[i]), downloadsPerStatus[i]);
+    }
+    writer.addMetric("videodownloader_queued_downloads", "gauge", "Number of downloads waiting to be initiated or started automatically.");
+    writer.addSample("videodownloader_queued_downloads", "queue", QStringLiteral("init"), m_scheduler->downloadsToInit());
+    writer.addSample("videodownloader_queued_downloads", "queue", QStringLiteral("start"), m_scheduler->downloadsToStart());
+    writer.addMetric("videodownloader_received_bytes_total", "counter", "Total number of bytes received (persisted across sessions).");
+    writer.addSample("videodownloader_received_bytes_total", static_cast<double>(StatsPage::bytesReceived()));
+    writer.addMetric("videodownloader_host_received_bytes_total", "counter", "Number of bytes received in this session by host.");
+    for (auto i = m_bytesReceivedPerHost.cbegin(), end = m_bytesReceivedPerHost.cend(); i != end; ++i) {
+        writer.addSample("videodownloader_host_received_bytes_total", "host", i.key(), static_cast<double>(i.value()));
+    }
+    writer.addMetric("videodownloader_speed_bytes_per_second", "gauge", "Current aggregate download speed.");
+    writer.addSample("videodownloader_speed_bytes_per_second", m_totalSpeed * 125.0);
+    writer.addMetric("videodownloader_read_buffer_bytes", "gauge", "Size of the read buffers of the running downloads.");
+    writer.addSample("videodownloader_read_buffer_bytes", readBufferSize);
+    writer.addMetric("videodownloader_write_backlog_bytes", "gauge", "Received bytes waiting in memory to be written to the output device.");
+    writer.addSample("videodownloader_write_backlog_bytes", bufferedBytes);
+    writer.addMetric("videodownloader_retries_total", "counter", "Number of requests retried in this session.");
+    writer.addSample("videodownloader_retries_total", static_cast<double>(HttpDownload::totalRetries()));
+}
+
+void MainWindow::setPriorityOfSelectedDownloads(DownloadPriority priority)
+{
+    for (Download *download : selectedDownloads()) {
+        download->setPriority(priority);
+    }
+}
+
 void MainWindow::setDownloadRange()
 {
     QList<Download *> downloads = selectedDownloads();
@@ -826,7 +920,6 @@ void MainWindow::downloadChangedStatus(Download *download)
     }
     updateOverallStatus(download);
     updateStartStopControls();
-    checkForDownloadsToStartAutomatically();
 }
 
 void MainWindow::downloadChangedProgress(Download *download)
@@ -841,9 +934,17 @@ void MainWindow::updateOverallStatus(Download *download)
     qint64 newBytesReceived = download->newBytesReceived();
     qint64 newBytesToReceive = download->newBytesToReceive();
     m_totalSpeed += download->shiftSpeed();
+    m_totalAverageSpeed += download->shiftAverageSpeed();
     StatsPage::bytesReceived() += newBytesReceived;
+    if (newBytesReceived > 0) {
+        m_bytesReceivedPerHost[download->downloadUrl().host()] += static_cast<quint64>(newBytesReceived);
+    }
     m_stillToReceive += newBytesToReceive - newBytesReceived;
-    m_remainingTime = m_totalSpeed > 0 ? TimeSpan::fromSeconds(static_cast<double>(m_stillToReceive) / (m_totalSpeed * 125.0)) : TimeSpan();
+    // estimate the remaining time from the average speed over the recent progress updates which is less biased by the
+    // last updates than the displayed speed
+    m_remainingTime = m_totalAverageSpeed > 0
+        ? TimeSpan::fromSeconds(static_cast<double>(m_stillToReceive) / (m_totalAverageSpeed * 125.0))
+        : TimeSpan();
     if (m_activeDownloads >= 1) {
         // if there are active downloads, show it in the status bar and as tray icon tooltip
         QString status = tr("%1 active download").arg(m_activeDownloads);
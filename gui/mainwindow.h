@@ -4,6 +4,7 @@
 #include <c++utilities/chrono/timespan.h>
 
 #include <QElapsedTimer>
+#include <QHash>
 #include <QList>
 #include <QMainWindow>
 #include <QSystemTrayIcon>
@@ -23,7 +24,10 @@ class AboutDialog;
 
 namespace Network {
 class Download;
-}
+class DownloadScheduler;
+class MetricsWriter;
+enum class DownloadPriority;
+} // namespace Network
 
 namespace QtGui {
 class DownloadInteraction;
@@ -54,7 +58,6 @@ private Q_SLOTS:
     void downloadChangedProgress(Network::Download *download);
 
     void updateOverallStatus(Network::Download *download);
-    void checkForDownloadsToStartAutomatically();
     void startOrStopSelectedDownloads();
     void interruptOrResumeSelectedDownloads();
     void removeSelectedDownloads();
@@ -89,6 +92,12 @@ private:
     // methods to handle downloads
     void addDownload(Network::Download *download);
     QList<Network::Download *> selectedDownloads() const;
+    void setPriorityOfSelectedDownloads(Network::DownloadPriority priority);
+    void copyTransferTimings();
+    void collectMetrics(Network::MetricsWriter &writer) const;
+#ifdef VIDEODOWNLOADER_TRACING
+    void saveTrace();
+#endif
     void setupTrayIcon();
 
     // fields
@@ -103,6 +112,7 @@ private:
     bool m_internalClipboardChange;
     //  model, deleagtes
     DownloadModel *m_model;
+    Network::DownloadScheduler *m_scheduler;
     ProgressBarItemDelegate *m_progressBarDelegate;
     ComboBoxItemDelegate *m_comboBoxDelegate;
     //  overall download status
@@ -110,7 +120,9 @@ private:
     int m_downloadsToStart;
     int m_initiatingDownloads;
     double m_totalSpeed;
+    double m_totalAverageSpeed;
     qint64 m_stillToReceive;
+    QHash<QString, quint64> m_bytesReceivedPerHost;
     CppUtilities::TimeSpan m_remainingTime;
     QElapsedTimer m_elapsedTime;
     DownloadInteraction *m_downloadInteraction;
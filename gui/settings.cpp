@@ -2,6 +2,12 @@
 
 #include "../network/download.h"
 #include "../network/groovesharkdownload.h"
+#include "../network/misc/http2policy.h"
+#include "../network/misc/metricsexporter.h"
+#include "../network/misc/negativeresultcache.h"
+#include "../network/misc/proxypool.h"
+#include "../network/misc/rateestimator.h"
+#include "../network/misc/sslsessioncache.h"
 
 #include "resources/config.h"
 
@@ -26,9 +32,11 @@
 #include <QGraphicsPixmapItem>
 #include <QHBoxLayout>
 #include <QLabel>
+#include <QLineEdit>
 #include <QMessageBox>
 #include <QNetworkProxy>
 #include <QSettings>
+#include <QSpinBox>
 #include <QVBoxLayout>
 
 #include <functional>
@@ -205,6 +213,8 @@ bool ProxyPage::apply()
         proxy().setPort(ui()->portSpinBox->value());
         proxy().setUser(ui()->userNameLineEdit->text());
         proxy().setPassword(ui()->passwordLineEdit->text());
+        additionalProxies() = ui()->additionalProxiesPlainTextEdit->toPlainText().split(QChar('\n'), Qt::SkipEmptyParts);
+        updateProxyPool();
     }
     return true;
 }
@@ -234,6 +244,7 @@ void ProxyPage::reset()
         ui()->portSpinBox->setValue(proxy().port());
         ui()->userNameLineEdit->setText(proxy().user());
         ui()->passwordLineEdit->setText(proxy().password());
+        ui()->additionalProxiesPlainTextEdit->setPlainText(additionalProxies().join(QChar('\n')));
     }
 }
 
@@ -243,6 +254,43 @@ QNetworkProxy &ProxyPage::proxy()
     return proxy;
 }
 
+QStringList &ProxyPage::additionalProxies()
+{
+    static QStringList proxies;
+    return proxies;
+}
+
+/*!
+ * \brief Assigns the proxy and the additional proxies to the ProxyPool.
+ *
+ * The additional proxies are of the same type as the proxy and use its credentials unless
+ * specified otherwise. The pool is left empty if there are no additional proxies so only
+ * the proxy assigned via applySettingsToDownload() is used in this case.
+ */
+void ProxyPage::updateProxyPool()
+{
+    const QNetworkProxy &mainProxy = proxy();
+    QList<QNetworkProxy> proxies;
+    if (mainProxy.type() != QNetworkProxy::NoProxy && !additionalProxies().isEmpty()) {
+        proxies << mainProxy;
+        for (const QString &additionalProxy : additionalProxies()) {
+            const QUrl url(QStringLiteral("proxy://") + additionalProxy.trimmed());
+            if (!url.isValid() || url.host().isEmpty()) {
+                continue;
+            }
+            QNetworkProxy proxy(mainProxy);
+            proxy.setHostName(url.host());
+            proxy.setPort(static_cast<quint16>(url.port(mainProxy.port())));
+            if (!url.userName().isEmpty()) {
+                proxy.setUser(url.userName());
+                proxy.setPassword(url.password());
+            }
+            proxies << proxy;
+        }
+    }
+    ProxyPool::instance().setProxies(proxies);
+}
+
 QWidget *ProxyPage::setupWidget()
 {
     QWidget *widget = ProxyPageBase::setupWidget();
@@ -312,6 +360,11 @@ QString &UserAgentPage::customUserAgent()
 MiscPage::MiscPage(QWidget *parentWidget)
     : OptionPage(parentWidget)
     , m_redirectCheckBox(nullptr)
+    , m_persistSslSessionsCheckBox(nullptr)
+    , m_negativeResultCacheSpinBox(nullptr)
+    , m_http2CheckBox(nullptr)
+    , m_http2ExceptionsLineEdit(nullptr)
+    , m_speedHalfLifeSpinBox(nullptr)
 {
 }
 
@@ -323,6 +376,12 @@ bool MiscPage::apply()
 {
     if (hasBeenShown()) {
         redirectWithoutAsking() = m_redirectCheckBox->isChecked();
+        persistSslSessions() = m_persistSslSessionsCheckBox->isChecked();
+        NegativeResultCache::instance().setExpiryTime(m_negativeResultCacheSpinBox->value() * 60);
+        Http2Policy &http2Policy = Http2Policy::instance();
+        http2Policy.setEnabledByDefault(m_http2CheckBox->isChecked());
+        http2Policy.setExceptions(m_http2ExceptionsLineEdit->text().split(QChar(','), Qt::SkipEmptyParts));
+        RateEstimator::setDefaultHalfLife(m_speedHalfLifeSpinBox->value() * 1000);
     }
     return true;
 }
@@ -331,6 +390,12 @@ void MiscPage::reset()
 {
     if (hasBeenShown()) {
         m_redirectCheckBox->setChecked(redirectWithoutAsking());
+        m_persistSslSessionsCheckBox->setChecked(persistSslSessions());
+        m_negativeResultCacheSpinBox->setValue(NegativeResultCache::instance().expiryTime() / 60);
+        const Http2Policy &http2Policy = Http2Policy::instance();
+        m_http2CheckBox->setChecked(http2Policy.isEnabledByDefault());
+        m_http2ExceptionsLineEdit->setText(http2Policy.exceptions().join(QStringLiteral(", ")));
+        m_speedHalfLifeSpinBox->setValue(RateEstimator::defaultHalfLife() / 1000);
     }
 }
 
@@ -340,6 +405,16 @@ bool &MiscPage::redirectWithoutAsking()
     return val;
 }
 
+/*!
+ * \brief Returns whether TLS session tickets are stored in the settings to resume sessions after a restart.
+ * \remarks Disabled by default because the tickets are secrets which would be stored in plain text.
+ */
+bool &MiscPage::persistSslSessions()
+{
+    static bool val = false;
+    return val;
+}
+
 QWidget *MiscPage::setupWidget()
 {
     QWidget *widget = new QWidget();
@@ -347,6 +422,39 @@ QWidget *MiscPage::setupWidget()
     QVBoxLayout *layout = new QVBoxLayout(widget);
     layout->addWidget(
         m_redirectCheckBox = new QCheckBox(QApplication::translate("QtGui::NetworkMiscOptionPage", "Follow redirections without asking"), widget));
+    layout->addWidget(m_persistSslSessionsCheckBox = new QCheckBox(
+                          QApplication::translate("QtGui::NetworkMiscOptionPage", "Remember TLS sessions after restarting the application"), widget));
+    m_persistSslSessionsCheckBox->setToolTip(QApplication::translate("QtGui::NetworkMiscOptionPage",
+        "Allows resuming TLS sessions with a shortened handshake. The session tickets are secrets which are stored unencrypted in the "
+        "settings file."));
+#ifdef QT_NO_OPENSSL
+    m_persistSslSessionsCheckBox->setEnabled(false);
+#endif
+    QFormLayout *formLayout = new QFormLayout();
+    m_negativeResultCacheSpinBox = new QSpinBox(widget);
+    m_negativeResultCacheSpinBox->setRange(0, 24 * 60);
+    m_negativeResultCacheSpinBox->setSuffix(QApplication::translate("QtGui::NetworkMiscOptionPage", " min"));
+    m_negativeResultCacheSpinBox->setSpecialValueText(QApplication::translate("QtGui::NetworkMiscOptionPage", "disabled"));
+    m_negativeResultCacheSpinBox->setToolTip(QApplication::translate("QtGui::NetworkMiscOptionPage",
+        "Downloads for URLs which have not been found recently fail instantly instead of being requested again."));
+    formLayout->addRow(
+        QApplication::translate("QtGui::NetworkMiscOptionPage", "Remember unavailable URLs for"), m_negativeResultCacheSpinBox);
+    m_speedHalfLifeSpinBox = new QSpinBox(widget);
+    m_speedHalfLifeSpinBox->setRange(1, 60);
+    m_speedHalfLifeSpinBox->setSuffix(QApplication::translate("QtGui::NetworkMiscOptionPage", " s"));
+    m_speedHalfLifeSpinBox->setToolTip(QApplication::translate("QtGui::NetworkMiscOptionPage",
+        "Higher values make the displayed speed and remaining time more stable but let them react slower to changes. Applies to "
+        "downloads added afterwards."));
+    formLayout->addRow(QApplication::translate("QtGui::NetworkMiscOptionPage", "Speed averaging half-life"), m_speedHalfLifeSpinBox);
+    m_http2ExceptionsLineEdit = new QLineEdit(widget);
+    m_http2ExceptionsLineEdit->setPlaceholderText(QApplication::translate("QtGui::NetworkMiscOptionPage", "comma-separated list of hosts"));
+    formLayout->addRow(QApplication::translate("QtGui::NetworkMiscOptionPage", "HTTP/2 exceptions"), m_http2ExceptionsLineEdit);
+    layout->addWidget(m_http2CheckBox = new QCheckBox(
+                          QApplication::translate("QtGui::NetworkMiscOptionPage", "Use HTTP/2 to multiplex requests to the same host if supported"), widget));
+    m_http2CheckBox->setToolTip(QApplication::translate("QtGui::NetworkMiscOptionPage",
+        "The setting is inverted for the hosts listed as exceptions (including their subdomains)."));
+    layout->addLayout(formLayout);
+    layout->addStretch();
     widget->setLayout(layout);
     return widget;
 }
@@ -354,6 +462,8 @@ QWidget *MiscPage::setupWidget()
 StatsPage::StatsPage(QWidget *parentWidget)
     : OptionPage(parentWidget)
     , m_receivedLabel(nullptr)
+    , m_metricsCheckBox(nullptr)
+    , m_metricsPortSpinBox(nullptr)
 {
 }
 
@@ -363,6 +473,16 @@ StatsPage::~StatsPage()
 
 bool StatsPage::apply()
 {
+    if (hasBeenShown()) {
+        MetricsExporter &exporter = MetricsExporter::instance();
+        exporter.setEnabled(m_metricsCheckBox->isChecked(), static_cast<quint16>(m_metricsPortSpinBox->value()));
+        if (exporter.isEnabled() && !exporter.isListening()) {
+            errors() << QApplication::translate("QtGui::NetworkStatsOptionPage", "Unable to serve metrics on port %1: %2")
+                            .arg(exporter.port())
+                            .arg(exporter.errorString());
+            return false;
+        }
+    }
     return true;
 }
 
@@ -370,6 +490,9 @@ void StatsPage::reset()
 {
     if (hasBeenShown()) {
         m_receivedLabel->setText(QString::fromStdString(dataSizeToString(bytesReceived(), true)));
+        const MetricsExporter &exporter = MetricsExporter::instance();
+        m_metricsCheckBox->setChecked(exporter.isEnabled());
+        m_metricsPortSpinBox->setValue(exporter.port());
     }
 }
 
@@ -391,6 +514,16 @@ QWidget *StatsPage::setupWidget()
     QObject::connect(refreshButton, &QPushButton::clicked, std::bind(&StatsPage::reset, this));
     mainLayout->addLayout(formLayout);
     mainLayout->addWidget(refreshButton);
+    mainLayout->addWidget(m_metricsCheckBox = new QCheckBox(
+                              QApplication::translate("QtGui::NetworkStatsOptionPage", "Serve metrics for Prometheus on localhost"), widget));
+    QFormLayout *metricsLayout = new QFormLayout();
+    m_metricsPortSpinBox = new QSpinBox(widget);
+    m_metricsPortSpinBox->setRange(1, 65535);
+    m_metricsPortSpinBox->setToolTip(
+        QApplication::translate("QtGui::NetworkStatsOptionPage", "The metrics are available under http://localhost:<port>/metrics."));
+    metricsLayout->addRow(QApplication::translate("QtGui::NetworkStatsOptionPage", "Port"), m_metricsPortSpinBox);
+    mainLayout->addLayout(metricsLayout);
+    mainLayout->addStretch();
     widget->setLayout(mainLayout);
     return widget;
 }
@@ -449,6 +582,10 @@ void restoreSettings()
     TargetPage::overwriteWithoutAsking() = settings.value("overwritewithoutasking", false).toBool();
     TargetPage::determineTargetFileWithoutAsking() = settings.value("determinetargetfilewithoutasking", true).toBool();
     MiscPage::redirectWithoutAsking() = settings.value("redirectwithoutasking", true).toBool();
+    NegativeResultCache::instance().setExpiryTime(settings.value("negativeresultcacheexpiry", 30 * 60).toInt());
+    Http2Policy::instance().setEnabledByDefault(settings.value("http2enabled", false).toBool());
+    Http2Policy::instance().setExceptions(settings.value("http2exceptions").toStringList());
+    RateEstimator::setDefaultHalfLife(settings.value("speedhalflife", 3000).toInt());
     UserAgentPage::useCustomUserAgent() = settings.value("usecustomuseragent", false).toBool();
     UserAgentPage::customUserAgent() = settings.value("customuseragent").toString();
 
@@ -462,11 +599,21 @@ void restoreSettings()
     proxy.setPort(settings.value("port", QVariant(0)).toUInt());
     proxy.setUser(settings.value("user").toString());
     proxy.setPassword(settings.value("password").toString());
+    ProxyPage::additionalProxies() = settings.value("additionalproxies").toStringList();
+    ProxyPage::updateProxyPool();
     settings.endGroup();
+    MiscPage::persistSslSessions() = settings.value("persistsslsessions", false).toBool();
+#ifndef QT_NO_OPENSSL
+    if (MiscPage::persistSslSessions()) {
+        SslSessionCache::instance().restoreFromVariantMap(settings.value("sslsessiontickets").toMap());
+    }
+#endif
     settings.endGroup();
 
     settings.beginGroup("statistics");
     StatsPage::bytesReceived() = settings.value("totalbytesreceived", 0).toLongLong();
+    MetricsExporter::instance().setEnabled(settings.value("metricsenabled", false).toBool(),
+        static_cast<quint16>(settings.value("metricsport", MetricsExporter::defaultPort).toUInt()));
     settings.endGroup();
 
     settings.beginGroup("mainwindow");
@@ -491,6 +638,10 @@ void saveSettings()
     settings.setValue("overwritewithoutasking", TargetPage::overwriteWithoutAsking());
     settings.setValue("determinetargetfilewithoutasking", TargetPage::determineTargetFileWithoutAsking());
     settings.setValue("redirectwithoutasking", MiscPage::redirectWithoutAsking());
+    settings.setValue("negativeresultcacheexpiry", NegativeResultCache::instance().expiryTime());
+    settings.setValue("http2enabled", Http2Policy::instance().isEnabledByDefault());
+    settings.setValue("http2exceptions", Http2Policy::instance().exceptions());
+    settings.setValue("speedhalflife", RateEstimator::defaultHalfLife());
     settings.setValue("usecustomuseragent", UserAgentPage::useCustomUserAgent());
     settings.setValue("customuseragent", UserAgentPage::customUserAgent());
 
@@ -501,11 +652,23 @@ void saveSettings()
     settings.setValue("port", proxy.port());
     settings.setValue("user", proxy.user());
     settings.setValue("password", proxy.password());
+    settings.setValue("additionalproxies", ProxyPage::additionalProxies());
     settings.endGroup();
+    settings.setValue("persistsslsessions", MiscPage::persistSslSessions());
+#ifndef QT_NO_OPENSSL
+    if (MiscPage::persistSslSessions()) {
+        settings.setValue("sslsessiontickets", SslSessionCache::instance().toVariantMap());
+    } else {
+        // ensure no tickets are left over from a version which persisted them unconditionally
+        settings.remove("sslsessiontickets");
+    }
+#endif
     settings.endGroup();
 
     settings.beginGroup("statistics");
     settings.setValue("totalbytesreceived", StatsPage::bytesReceived());
+    settings.setValue("metricsenabled", MetricsExporter::instance().isEnabled());
+    settings.setValue("metricsport", MetricsExporter::instance().port());
     settings.endGroup();
 
     settings.beginGroup("mainwindow");
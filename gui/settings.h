@@ -4,11 +4,14 @@
 #include <qtutilities/settingsdialog/optionpage.h>
 #include <qtutilities/settingsdialog/settingsdialog.h>
 
+#include <QStringList>
+
 QT_FORWARD_DECLARE_CLASS(QByteArray)
 QT_FORWARD_DECLARE_CLASS(QLabel)
 QT_FORWARD_DECLARE_CLASS(QLineEdit)
 QT_FORWARD_DECLARE_CLASS(QCheckBox)
 QT_FORWARD_DECLARE_CLASS(QNetworkProxy)
+QT_FORWARD_DECLARE_CLASS(QSpinBox)
 
 namespace QtUtilities {
 class QtSettings;
@@ -46,6 +49,8 @@ BEGIN_DECLARE_UI_FILE_BASED_OPTION_PAGE(ProxyPage)
 DECLARE_SETUP_WIDGETS
 public:
 static QNetworkProxy &proxy();
+static QStringList &additionalProxies();
+static void updateProxyPool();
 
 private:
 void updateProxy();
@@ -61,9 +66,15 @@ BEGIN_DECLARE_OPTION_PAGE(MiscPage)
 DECLARE_SETUP_WIDGETS
 public:
 static bool &redirectWithoutAsking();
+static bool &persistSslSessions();
 
 private:
 QCheckBox *m_redirectCheckBox;
+QCheckBox *m_persistSslSessionsCheckBox;
+QSpinBox *m_negativeResultCacheSpinBox;
+QCheckBox *m_http2CheckBox;
+QLineEdit *m_http2ExceptionsLineEdit;
+QSpinBox *m_speedHalfLifeSpinBox;
 END_DECLARE_OPTION_PAGE
 
 BEGIN_DECLARE_OPTION_PAGE(StatsPage)
@@ -73,6 +84,8 @@ static quint64 &bytesReceived();
 
 private:
 QLabel *m_receivedLabel;
+QCheckBox *m_metricsCheckBox;
+QSpinBox *m_metricsPortSpinBox;
 END_DECLARE_OPTION_PAGE
 
 class SettingsDialog : public QtUtilities::SettingsDialog {
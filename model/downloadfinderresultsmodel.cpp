@@ -36,11 +36,11 @@ void DownloadFinderResultsModel::setFinder(DownloadFinder *finder)
             // results are about to be cleared
             connect(m_finder, &DownloadFinder::aboutToClearResults, std::bind(&DownloadFinderResultsModel::beginResetModel, this));
             // results have been cleared
-            connect(m_finder, &DownloadFinder::clearResults, std::bind(&DownloadFinderResultsModel::endResetModel, this));
+            connect(m_finder, &DownloadFinder::resultsCleared, std::bind(&DownloadFinderResultsModel::endResetModel, this));
             // new results are about to be available
             connect(m_finder, &DownloadFinder::aboutToMakeNewResultsAvailable, [this](unsigned int count) {
                 if (count > 0) {
-                    beginInsertRows(QModelIndex(), rowCount(), count - 1);
+                    beginInsertRows(QModelIndex(), rowCount(), rowCount() + static_cast<int>(count) - 1);
                 }
             });
             // new results are available
@@ -2,8 +2,17 @@
 
 #include "../network/download.h"
 
+#include "../application/tracing.h"
+
 #include <c++utilities/conversion/stringconversion.h>
 
+#include <QJsonObject>
+#include <QStringBuilder>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 using namespace CppUtilities;
 using namespace Network;
 
@@ -12,6 +21,10 @@ namespace QtGui {
 /*!
  * \class DownloadModel
  * \brief The DownloadModel class provides a model interface for a list of downloads.
+ *
+ * Status and progress changes of downloads are not propagated immediately. They are collected and
+ * emitted as dataChanged() signals for contiguous ranges of rows when the update timer fires. This
+ * limits the number of repaints when many downloads are active.
  */
 
 /*!
@@ -20,6 +33,9 @@ namespace QtGui {
 DownloadModel::DownloadModel(QObject *parent)
     : QAbstractItemModel(parent)
 {
+    m_updateTimer.setSingleShot(true);
+    m_updateTimer.setInterval(100);
+    connect(&m_updateTimer, &QTimer::timeout, this, &DownloadModel::flushPendingChanges);
 }
 
 QVariant DownloadModel::data(const QModelIndex &index, int role) const
@@ -50,25 +66,55 @@ QVariant DownloadModel::data(const QModelIndex &index, int role) const
                     return statusString(download);
                 case progressColumn():
                     return progressString(download);
+                case priorityColumn():
+                    return priorityName(download->priority());
                 }
                 break;
             case Qt::ToolTipRole:
                 switch (index.column()) {
                 case statusColumn():
+                    if (download->isValidOptionChosen()) {
+                        const auto timings = download->options().at(download->chosenOption()).transferTimings().toString();
+                        if (!timings.isEmpty() && download->statusInfo().isEmpty()) {
+                            return timings;
+                        } else if (!timings.isEmpty()) {
+                            return QString(download->statusInfo() % QStringLiteral("\n\n") % timings);
+                        }
+                    }
                     return download->statusInfo();
+                case progressColumn():
+                    if (download->isValidOptionChosen()) {
+                        if (const auto readBufferSize = download->options().at(download->chosenOption()).readBufferSize()) {
+                            return tr("Read buffer: %1").arg(QString::fromStdString(dataSizeToString(readBufferSize)));
+                        }
+                    }
+                    break;
                 default:;
                 }
                 break;
             case DownloadModel::ProgressPercentageRole:
                 return download->progressPercentage();
+            case DownloadModel::TransferTimingsRole:
+                if (download->isValidOptionChosen()) {
+                    return download->options().at(download->chosenOption()).transferTimings().toJson();
+                }
+                break;
             case DownloadModel::AvailableOptionsRole: {
                 QStringList optionNames;
+                if (index.column() == priorityColumn()) {
+                    optionNames << priorityName(DownloadPriority::Urgent) << priorityName(DownloadPriority::Normal)
+                                << priorityName(DownloadPriority::Background);
+                    return optionNames;
+                }
                 for (const OptionData &optionData : download->options()) {
                     optionNames << optionData.name();
                 }
                 return optionNames;
             }
             case DownloadModel::ChosenOptionRole:
+                if (index.column() == priorityColumn()) {
+                    return static_cast<int>(download->priority());
+                }
                 return QVariant::fromValue(download->chosenOption());
             default:;
             }
@@ -84,7 +130,16 @@ bool DownloadModel::setData(const QModelIndex &index, const QVariant &value, int
         case DownloadModel::ChosenOptionRole: {
             bool ok;
             int chosenOption = value.toInt(&ok);
-            if (ok) {
+            if (ok && index.column() == priorityColumn()) {
+                // the view is updated via downloadPriorityChanged()
+                if (Download *download = this->download(index)) {
+                    if (chosenOption >= static_cast<int>(DownloadPriority::Urgent)
+                        && chosenOption <= static_cast<int>(DownloadPriority::Background)) {
+                        download->setPriority(static_cast<DownloadPriority>(chosenOption));
+                        return true;
+                    }
+                }
+            } else if (ok) {
                 if (Download *download = this->download(index)) {
                     if (download->setChosenOption(chosenOption)) {
                         QModelIndex downloadUrlIndex = this->index(index.row(), downloadUrlColumn());
@@ -125,6 +180,8 @@ QVariant DownloadModel::headerData(int section, Qt::Orientation orientation, int
                 return tr("Status");
             case progressColumn():
                 return tr("Progress");
+            case priorityColumn():
+                return tr("Priority");
             default:;
             }
             break;
@@ -141,6 +198,7 @@ Qt::ItemFlags DownloadModel::flags(const QModelIndex &index) const
     if (index.isValid()) {
         switch (index.column()) {
         case optionsColumn():
+        case priorityColumn():
             return QAbstractItemModel::flags(index) | Qt::ItemIsEditable;
         default:;
         }
@@ -155,7 +213,7 @@ QModelIndex DownloadModel::index(int row, int column, const QModelIndex &parent)
 
 QModelIndex DownloadModel::index(Download *download, int column)
 {
-    int row = m_downloads.indexOf(download);
+    const auto row = m_rows.value(download, -1);
     return row >= 0 ? index(row, column) : QModelIndex();
 }
 
@@ -186,13 +244,15 @@ int DownloadModel::columnCount(const QModelIndex &) const
  */
 void DownloadModel::addDownload(Download *download)
 {
-    if (!m_downloads.contains(download)) {
+    if (!m_rows.contains(download)) {
         int index = m_downloads.size();
         beginInsertRows(QModelIndex(), index, index);
         connect(download, &Download::statusChanged, this, &DownloadModel::downloadChangedStatus);
         connect(download, &Download::progressChanged, this, &DownloadModel::downloadProgressChanged);
         connect(download, &Download::statusInfoChanged, this, &DownloadModel::downloadInfoChanged);
+        connect(download, &Download::priorityChanged, this, &DownloadModel::downloadPriorityChanged);
         m_downloads << download;
+        m_rows.insert(download, index);
         endInsertRows();
     }
 }
@@ -204,13 +264,70 @@ void DownloadModel::addDownload(Download *download)
  */
 void DownloadModel::removeDownload(Download *download)
 {
-    int index = m_downloads.indexOf(download);
-    while (index >= 0) {
-        beginRemoveRows(QModelIndex(), index, index);
-        download->disconnect(this);
-        m_downloads.removeAt(index);
+    const auto index = m_rows.value(download, -1);
+    if (index < 0) {
+        return;
+    }
+    beginRemoveRows(QModelIndex(), index, index);
+    download->disconnect(this);
+    m_pendingChanges.remove(download);
+    m_rows.remove(download);
+    m_downloads.removeAt(index);
+    updateRows(index);
+    endRemoveRows();
+}
+
+/*!
+ * \brief Removes the specified \a downloads from the model.
+ *
+ * Contiguous rows are removed at once and the row index is only updated once so this is much
+ * faster than calling removeDownload() for each download. Downloads which are not in the model
+ * are ignored.
+ */
+void DownloadModel::removeDownloads(const QList<Download *> &downloads)
+{
+    // determine the rows to be removed
+    QVector<int> rows;
+    rows.reserve(downloads.size());
+    for (Download *download : downloads) {
+        const auto row = m_rows.value(download, -1);
+        if (row >= 0) {
+            rows << row;
+            download->disconnect(this);
+            m_pendingChanges.remove(download);
+        }
+    }
+    if (rows.isEmpty()) {
+        return;
+    }
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+    // remove contiguous ranges starting from the end so the rows of the remaining ranges stay valid
+    for (auto lastRow = rows.size() - 1; lastRow >= 0;) {
+        auto firstRow = lastRow;
+        while (firstRow > 0 && rows.at(firstRow - 1) == rows.at(firstRow) - 1) {
+            --firstRow;
+        }
+        const auto first = rows.at(firstRow), last = rows.at(lastRow);
+        beginRemoveRows(QModelIndex(), first, last);
+        for (auto row = first; row <= last; ++row) {
+            m_rows.remove(m_downloads.at(row));
+        }
+        m_downloads.erase(m_downloads.begin() + first, m_downloads.begin() + last + 1);
         endRemoveRows();
-        index = m_downloads.indexOf(download); // should be -1
+        lastRow = firstRow - 1;
+    }
+    updateRows(rows.front());
+}
+
+/*!
+ * \brief Updates the row index for all rows starting from \a firstRow.
+ */
+void DownloadModel::updateRows(int firstRow)
+{
+    for (int row = firstRow, rowCount = m_downloads.size(); row < rowCount; ++row) {
+        m_rows[m_downloads.at(row)] = row;
     }
 }
 
@@ -243,11 +360,7 @@ Download *DownloadModel::download(int row) const
  */
 void DownloadModel::downloadChangedStatus(Download *download)
 {
-    QModelIndex topLeft = index(download, 0);
-    QModelIndex bottomRight = index(download, lastColumn());
-    if (topLeft.isValid() && bottomRight.isValid()) {
-        emit dataChanged(topLeft, bottomRight, QVector<int>() << Qt::DisplayRole);
-    }
+    markChanged(download, 0, lastColumn(), true, false);
 }
 
 /*!
@@ -255,12 +368,7 @@ void DownloadModel::downloadChangedStatus(Download *download)
  */
 void DownloadModel::downloadProgressChanged(Download *download)
 {
-    // emit the data changed signal
-    QModelIndex topLeft = index(download, statusColumn());
-    QModelIndex bottomRight = index(download, lastColumn());
-    if (topLeft.isValid() && bottomRight.isValid()) {
-        emit dataChanged(topLeft, bottomRight, QVector<int>() << Qt::DisplayRole);
-    }
+    markChanged(download, statusColumn(), lastColumn(), true, false);
 }
 
 /*!
@@ -268,9 +376,96 @@ void DownloadModel::downloadProgressChanged(Download *download)
  */
 void DownloadModel::downloadInfoChanged(Download *download)
 {
-    QModelIndex topLeft = index(download, statusColumn());
-    if (topLeft.isValid()) {
-        emit dataChanged(topLeft, topLeft, QVector<int>() << Qt::ToolTipRole);
+    markChanged(download, statusColumn(), statusColumn(), false, true);
+}
+
+/*!
+ * \brief Handles a priority change.
+ */
+void DownloadModel::downloadPriorityChanged(Download *download)
+{
+    markChanged(download, priorityColumn(), priorityColumn(), true, false);
+}
+
+/*!
+ * \brief Records that the specified columns of the row of \a download have been changed.
+ *
+ * The change is emitted when the update timer fires.
+ */
+void DownloadModel::markChanged(Download *download, int firstColumn, int lastColumn, bool display, bool toolTip)
+{
+    auto pending = m_pendingChanges.find(download);
+    if (pending == m_pendingChanges.end()) {
+        m_pendingChanges.insert(download, PendingChange{ firstColumn, lastColumn, display, toolTip });
+    } else {
+        pending->firstColumn = qMin(pending->firstColumn, firstColumn);
+        pending->lastColumn = qMax(pending->lastColumn, lastColumn);
+        pending->display |= display;
+        pending->toolTip |= toolTip;
+    }
+    if (!m_updateTimer.isActive()) {
+        m_updateTimer.start();
+    }
+}
+
+/*!
+ * \brief Emits the dataChanged() signal for all changes recorded since the last flush.
+ *
+ * Adjacent rows are combined to a single signal. To do so the columns and roles of the changes
+ * are merged.
+ */
+void DownloadModel::flushPendingChanges()
+{
+    TRACE_SCOPE("DownloadModel::flushPendingChanges");
+    if (m_pendingChanges.isEmpty()) {
+        return;
+    }
+    QHash<Download *, PendingChange> pendingChanges;
+    pendingChanges.swap(m_pendingChanges);
+    int firstRow = -1, firstColumn = 0, lastColumn = 0;
+    bool display = false, toolTip = false;
+    const auto emitRange = [&](int rangeEnd) {
+        QVector<int> roles;
+        if (display) {
+            roles << Qt::DisplayRole;
+        }
+        if (toolTip) {
+            roles << Qt::ToolTipRole;
+        }
+        emit dataChanged(index(firstRow, firstColumn), index(rangeEnd, lastColumn), roles);
+        firstRow = -1;
+    };
+    // determine the rows of the changed downloads and sort them
+    std::vector<std::pair<int, PendingChange>> changedRows;
+    changedRows.reserve(static_cast<std::size_t>(pendingChanges.size()));
+    for (auto i = pendingChanges.cbegin(), end = pendingChanges.cend(); i != end; ++i) {
+        const auto row = m_rows.value(i.key(), -1);
+        if (row >= 0) {
+            changedRows.emplace_back(row, i.value());
+        }
+    }
+    std::sort(changedRows.begin(), changedRows.end(), [](const auto &lhs, const auto &rhs) { return lhs.first < rhs.first; });
+    int lastRow = -1;
+    for (const auto &[row, pending] : changedRows) {
+        if (firstRow >= 0 && row != lastRow + 1) {
+            emitRange(lastRow);
+        }
+        if (firstRow < 0) {
+            firstRow = row;
+            firstColumn = pending.firstColumn;
+            lastColumn = pending.lastColumn;
+            display = pending.display;
+            toolTip = pending.toolTip;
+        } else {
+            firstColumn = qMin(firstColumn, pending.firstColumn);
+            lastColumn = qMax(lastColumn, pending.lastColumn);
+            display |= pending.display;
+            toolTip |= pending.toolTip;
+        }
+        lastRow = row;
+    }
+    if (firstRow >= 0) {
+        emitRange(lastRow);
     }
 }
 
@@ -283,6 +478,22 @@ const QString &DownloadModel::infoString(const QString &infostring)
     return infostring.isEmpty() ? emptyField : infostring;
 }
 
+/*!
+ * \brief Returns the displayed name of the specified \a priority.
+ */
+QString DownloadModel::priorityName(DownloadPriority priority)
+{
+    switch (priority) {
+    case DownloadPriority::Urgent:
+        return tr("Urgent");
+    case DownloadPriority::Normal:
+        return tr("Normal");
+    case DownloadPriority::Background:
+        return tr("Background");
+    }
+    return QString();
+}
+
 /*!
  * \brief Returns a status string for the specified \a download.
  */
@@ -2,18 +2,26 @@
 #define DOWNLOADMODEL_H
 
 #include <QAbstractItemModel>
+#include <QHash>
 #include <QList>
+#include <QTimer>
 
 namespace Network {
 class Download;
-}
+enum class DownloadPriority;
+} // namespace Network
 
 namespace QtGui {
 
 class DownloadModel : public QAbstractItemModel {
     Q_OBJECT
 public:
-    enum ItemDataRole { ProgressPercentageRole = Qt::UserRole + 1, AvailableOptionsRole = Qt::UserRole + 2, ChosenOptionRole = Qt::UserRole + 3 };
+    enum ItemDataRole {
+        ProgressPercentageRole = Qt::UserRole + 1,
+        AvailableOptionsRole = Qt::UserRole + 2,
+        ChosenOptionRole = Qt::UserRole + 3,
+        TransferTimingsRole = Qt::UserRole + 4
+    };
 
     explicit DownloadModel(QObject *parent = nullptr);
 
@@ -30,6 +38,7 @@ public:
 
     void addDownload(Network::Download *download);
     void removeDownload(Network::Download *download);
+    void removeDownloads(const QList<Network::Download *> &downloads);
     Network::Download *download(const QModelIndex &index) const;
     Network::Download *download(int row) const;
 
@@ -41,21 +50,56 @@ public:
     static constexpr int typeColumn();
     static constexpr int statusColumn();
     static constexpr int progressColumn();
+    static constexpr int priorityColumn();
     static constexpr int lastColumn();
+    static QString priorityName(Network::DownloadPriority priority);
+
+    int updateInterval() const;
+    void setUpdateInterval(int milliseconds);
 
 private Q_SLOTS:
     void downloadChangedStatus(Network::Download *download);
     void downloadProgressChanged(Network::Download *download);
     void downloadInfoChanged(Network::Download *download);
+    void downloadPriorityChanged(Network::Download *download);
+    void flushPendingChanges();
 
 private:
+    struct PendingChange {
+        int firstColumn;
+        int lastColumn;
+        bool display;
+        bool toolTip;
+    };
+
     static const QString &infoString(const QString &infostring);
     static QString statusString(Network::Download *download);
     static QString progressString(Network::Download *download);
+    void markChanged(Network::Download *download, int firstColumn, int lastColumn, bool display, bool toolTip);
+    void updateRows(int firstRow);
 
     QList<Network::Download *> m_downloads;
+    QHash<Network::Download *, int> m_rows;
+    QHash<Network::Download *, PendingChange> m_pendingChanges;
+    QTimer m_updateTimer;
 };
 
+/*!
+ * \brief Returns the interval in milliseconds in which changes of downloads are propagated to views.
+ */
+inline int DownloadModel::updateInterval() const
+{
+    return m_updateTimer.interval();
+}
+
+/*!
+ * \brief Sets the interval in milliseconds in which changes of downloads are propagated to views.
+ */
+inline void DownloadModel::setUpdateInterval(int milliseconds)
+{
+    m_updateTimer.setInterval(milliseconds);
+}
+
 constexpr int DownloadModel::initialUrlColumn()
 {
     return 0;
@@ -96,9 +140,14 @@ constexpr int DownloadModel::progressColumn()
     return 7;
 }
 
+constexpr int DownloadModel::priorityColumn()
+{
+    return 8;
+}
+
 constexpr int DownloadModel::lastColumn()
 {
-    return progressColumn();
+    return priorityColumn();
 }
 } // namespace QtGui
 
@@ -1,11 +1,9 @@
 #include "./bitsharedownload.h"
 
-#include "../application/utils.h"
+#include "./misc/textscanner.h"
 
 #include <QUrlQuery>
 
-using namespace Application;
-
 namespace Network {
 
 /*!
@@ -36,14 +34,21 @@ QString BitshareDownload::typeName() const
 
 void BitshareDownload::evalVideoInformation(Download *, QBuffer *videoInfoBuffer)
 {
-    QString videoInfo(videoInfoBuffer->readAll());
+    static const QStringMatcher titleMarker(QStringLiteral("<title>Streaming "));
+    static const QStringMatcher titleEndMarker(QStringLiteral(" "));
+    static const QStringMatcher clipMarker(QStringLiteral("clip:"));
+    static const QStringMatcher urlMarker(QStringLiteral("url: '"));
+    static const QStringMatcher urlEndMarker(QStringLiteral("'"));
+
+    const QString videoInfo(videoInfoBuffer->readAll());
+    TextScanner scanner(videoInfo);
     QString title;
-    if (substring(videoInfo, title, 0, QStringLiteral("<title>Streaming "), QStringLiteral(" ")) > 0 && !title.isEmpty()) {
+    if (scanner.extract(titleMarker, titleEndMarker, title) && !title.isEmpty()) {
         setTitle(title);
     }
+    scanner.setPosition(0);
     QString url;
-    if (substring(videoInfo, url, videoInfo.indexOf(QLatin1String("clip:"), Qt::CaseSensitive), QStringLiteral("url: '"), QStringLiteral("'")) > 0
-        && !url.isEmpty()) {
+    if (scanner.skipTo(clipMarker) && scanner.extract(urlMarker, urlEndMarker, url) && !url.isEmpty()) {
         addDownloadUrl(tr("H.264/AAC/FLV"), url);
         reportInitiated(true);
     } else {
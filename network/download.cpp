@@ -1,5 +1,9 @@
 #include "./download.h"
+#include "./misc/negativeresultcache.h"
 #include "./permissionstatus.h"
+
+#include "../application/tracing.h"
+
 // these includes are only needed to provide the Download::fromUrl method
 #include "./bitsharedownload.h"
 #include "./httpdownload.h"
@@ -9,6 +13,7 @@
 #include <c++utilities/application/global.h>
 #include <c++utilities/io/path.h>
 
+#include <QDateTime>
 #include <QFileInfo>
 #include <QIODevice>
 #include <QMessageBox>
@@ -42,6 +47,7 @@ namespace Network {
  *  - followRedirection(): Starts the download again using the redirection URL; called when a redirection is available
  *    and the redirection is accepted.
  *  - isInitiatingInstantlyRecommendable(): Returns whether instantly initiating is recommendable.
+ *  - doProbeExpectedSize(): Determines the size of the chosen option without downloading it; optional.
  *  - supportsRange(): Returns whether a range can be set.
  *  - typeName(): Returns the type of the download as string (e. g. "Youtube Download").
  *
@@ -57,6 +63,9 @@ namespace Network {
  *  - reportFinalDownloadStatus(): Reports the final download status.
  *  - addDownloadUrl(): Makes a download URL under the specified option name available. Meant to be called during initialization.
  *  - changeDownloadUrl(): Updates the download URL with the specified option index.
+ *  - reportTransferPhase(): Reports that a phase of the transfer (see TransferTimings) has been reached; optional.
+ *  - reportTransferRedirect(): Reports that a transfer has been answered with a redirection; optional.
+ *  - reportExpectedSize(): Reports the size determined by doProbeExpectedSize() or during initialization.
  *
  * <h3>Signals to be handled when using the class:</h3>
  *  - overwriteingPermissionRequired(): Emitted when the permission to overwrite an existing file is required. Overwriting might be allowed or
@@ -165,6 +174,33 @@ bool Download::isInitiatingInstantlyRecommendable() const
     return false;
 }
 
+/*!
+ * \brief Determines the size of the chosen option without downloading it.
+ *
+ * The size is reported asynchronously using reportExpectedSize(). The default implementation does nothing
+ * so the size remains unknown until the actual download has been started.
+ */
+void Download::doProbeExpectedSize()
+{
+}
+
+/*!
+ * \brief Determines the expected size of the download if not known yet.
+ *
+ * The download must be initiated. The size is probed only once; the expectedSizeChanged() signal is
+ * emitted when the size has been determined.
+ *
+ * \sa expectedSize()
+ */
+void Download::probeExpectedSize()
+{
+    if (m_expectedSizeProbed || !isInitiated() || !isValidOptionChosen() || expectedSize() >= 0) {
+        return;
+    }
+    m_expectedSizeProbed = true;
+    doProbeExpectedSize();
+}
+
 /*!
  * \brief Constructs a new download for the specified \a url.
  * \returns Returns the download or nullptr if no download could be
@@ -226,6 +262,7 @@ bool Download::canStart(QString &reasonIfNot)
  */
 void Download::start()
 {
+    TRACE_SCOPE("Download::start");
     if (!isStarted()) {
         QString reasonForFail;
         if (canStart(reasonForFail)) {
@@ -367,13 +404,18 @@ Download::Download(const QUrl &url, QObject *parent)
     , m_bytesToReceive(-1)
     , m_newBytesReceived(0)
     , m_newBytesToReceive(0)
+    , m_expectedSize(-1)
+    , m_expectedSizeProbed(false)
     , m_speed(0.0)
     , m_shiftSpeed(0.0)
+    , m_shiftAverageSpeed(0.0)
     , m_networkError(QNetworkReply::NoError)
     , m_initiated(false)
+    , m_checkNegativeResultCache(false)
     , m_progressUpdateInterval(300)
     , m_useDefaultUserAgent(true)
     , m_proxy(QNetworkProxy::NoProxy)
+    , m_priority(DownloadPriority::Normal)
 {
     m_time.start();
 }
@@ -406,6 +448,12 @@ bool Download::setChosenOption(size_t optionIndex)
         if (m_chosenOption != optionIndex) {
             m_chosenOption = optionIndex;
             m_selectedOptionChanged = true;
+            // the expected size belongs to the previously chosen option
+            m_expectedSizeProbed = false;
+            if (m_expectedSize >= 0) {
+                m_expectedSize = -1;
+                emit expectedSizeChanged(this);
+            }
         }
         return true;
     } else {
@@ -417,12 +465,20 @@ bool Download::setChosenOption(size_t optionIndex)
  * \brief Starts initiating the download.
  *
  * The download will enter the initiating status. This method returns immediately.
+ *
+ * If initiating a download for the same URL or ID failed permanently within the time configured
+ * for the NegativeResultCache the download fails instantly instead. This only applies to downloads
+ * which have never been initiated before so explicitly retrying a failed download is still possible.
  */
 void Download::init()
 {
+    TRACE_SCOPE("Download::init");
     if ((!m_initiated) && (status() != DownloadStatus::Initiating)) {
+        m_checkNegativeResultCache = status() == DownloadStatus::None;
         setStatus(DownloadStatus::Initiating);
-        doInit();
+        if (!reportKnownInitiationFailure()) {
+            doInit();
+        }
     }
 }
 
@@ -437,6 +493,7 @@ void Download::init()
  */
 void Download::reportInitiated(bool success, const QString &reasonIfNot, const QNetworkReply::NetworkError &networkError)
 {
+    TRACE_SCOPE("Download::reportInitiated");
     setNetworkError(networkError);
     if (success) {
         m_initiated = true;
@@ -444,10 +501,86 @@ void Download::reportInitiated(bool success, const QString &reasonIfNot, const Q
     } else {
         m_initiated = false;
         setStatusInfo(tr("The initial information for this download couldn't be retireved. Reason: ") + reasonIfNot);
+        if (NegativeResultCache::isPermanentFailure(networkError)) {
+            rememberInitiationFailure(reasonIfNot, networkError);
+        }
         setStatus(DownloadStatus::Failed);
     }
 }
 
+/*!
+ * \brief Reports that the initialization failed and that retrying it is pointless.
+ *
+ * Might be called when subclassing instead of reportInitiated() if the initialization failed because the
+ * requested content does not exist (anymore). Further downloads for the same URL or ID will fail instantly
+ * for some time.
+ *
+ * \sa NegativeResultCache
+ */
+void Download::reportInitiationFailedPermanently(const QString &reason, QNetworkReply::NetworkError networkError)
+{
+    rememberInitiationFailure(reason, networkError);
+    reportInitiated(false, reason, networkError);
+}
+
+/*!
+ * \brief Reports a failure stored in the NegativeResultCache for this download if there is one.
+ * \returns Returns whether a failure has been reported.
+ *
+ * This method is called by init(). It might be called again when subclassing once the ID is known.
+ */
+bool Download::reportKnownInitiationFailure()
+{
+    if (!m_checkNegativeResultCache) {
+        return false;
+    }
+    auto &cache = NegativeResultCache::instance();
+    if (!cache.isEnabled()) {
+        return false;
+    }
+    QString reason;
+    auto networkError = QNetworkReply::NoError;
+    for (const auto &key : negativeResultCacheKeys()) {
+        if (cache.lookup(key, reason, networkError)) {
+            m_initiated = false;
+            m_checkNegativeResultCache = false;
+            setNetworkError(networkError);
+            setStatusInfo(tr("Initiating a download for the same URL failed recently so it has been skipped. Reason: ") + reason);
+            setStatus(DownloadStatus::Failed);
+            return true;
+        }
+    }
+    return false;
+}
+
+/*!
+ * \brief Returns the keys used to store failures of this download in the NegativeResultCache.
+ *
+ * Those are the initial URL and the ID (if already known).
+ */
+QStringList Download::negativeResultCacheKeys() const
+{
+    QStringList keys;
+    if (!m_initialUrl.isEmpty()) {
+        keys << m_initialUrl.adjusted(QUrl::NormalizePathSegments | QUrl::StripTrailingSlash | QUrl::RemoveFragment).toString();
+    }
+    if (!m_id.isEmpty()) {
+        keys << (QLatin1String(metaObject()->className()) + QChar(':') + m_id);
+    }
+    return keys;
+}
+
+/*!
+ * \brief Stores the specified failure in the NegativeResultCache.
+ */
+void Download::rememberInitiationFailure(const QString &reason, QNetworkReply::NetworkError networkError)
+{
+    auto &cache = NegativeResultCache::instance();
+    for (const auto &key : negativeResultCacheKeys()) {
+        cache.add(key, reason, networkError);
+    }
+}
+
 /*!
  * \brief Prepares the specified output \a device for the option with the specified \a optionIndex.
  * \remarks If there is already an output device assigned it must be
@@ -629,6 +762,10 @@ void Download::reportFinalDownloadStatus(size_t optionIndex, bool success, const
             // set current offset of the range to be able to resume downloading
             setStatusInfo(statusDescription);
             setNetworkError(networkError);
+            // remember the initial URL if it does not exist (anymore)
+            if (NegativeResultCache::isPermanentFailure(networkError) && optionData.url() == m_initialUrl) {
+                rememberInitiationFailure(statusDescription, networkError);
+            }
             setStatus(DownloadStatus::Failed);
         }
     }
@@ -677,6 +814,65 @@ void Download::reportDownloadProgressUpdate(size_t optionIndex, qint64 bytesRece
     }
 }
 
+/*!
+ * \brief Reports the size of the read buffer used to receive the data for the specified option.
+ *
+ * Might be called when subclassing to expose the read buffer size for diagnostic purposes.
+ *
+ * \sa OptionData::readBufferSize()
+ */
+void Download::reportReadBufferSize(size_t optionIndex, qint64 readBufferSize)
+{
+    m_optionData[optionIndex].m_readBufferSize = readBufferSize;
+}
+
+/*!
+ * \brief Reports that the transfer of the specified \a optionIndex reached the specified \a phase.
+ *
+ * Might be called when subclassing. Reporting TransferTimings::Phase::RequestIssued starts over; the
+ * redirections which lead to the option are kept so the timings of the final option contain all hops.
+ *
+ * \sa OptionData::transferTimings()
+ */
+void Download::reportTransferPhase(size_t optionIndex, TransferTimings::Phase phase)
+{
+    OptionData &optionData = m_optionData[optionIndex];
+    if (phase == TransferTimings::Phase::RequestIssued) {
+        optionData.m_transferTimings.clear();
+        if (optionData.m_redirectionOf != optionIndex && optionData.m_redirectionOf < m_optionData.size()) {
+            for (const auto redirect : m_optionData[optionData.m_redirectionOf].m_transferTimings.redirects()) {
+                optionData.m_transferTimings.recordRedirect(redirect);
+            }
+        }
+    }
+    optionData.m_transferTimings.record(phase, QDateTime::currentMSecsSinceEpoch());
+}
+
+/*!
+ * \brief Reports that the transfer of the specified \a optionIndex has been answered with a redirection.
+ *
+ * Might be called when subclassing before reportRedirectionAvailable() is called.
+ */
+void Download::reportTransferRedirect(size_t optionIndex)
+{
+    m_optionData[optionIndex].m_transferTimings.recordRedirect(QDateTime::currentMSecsSinceEpoch());
+}
+
+/*!
+ * \brief Reports the expected total number of bytes to receive for the chosen option.
+ *
+ * Might be called when subclassing after the size has been determined by doProbeExpectedSize() or during
+ * the initialization. Negative values are ignored.
+ */
+void Download::reportExpectedSize(qint64 expectedSize)
+{
+    if (expectedSize < 0 || m_expectedSize == expectedSize) {
+        return;
+    }
+    m_expectedSize = expectedSize;
+    emit expectedSizeChanged(this);
+}
+
 /*!
  * \brief Reports that new bytes are available.
  * \param inputDevice Specifies the device the download will read the available data from.
@@ -687,6 +883,7 @@ void Download::reportDownloadProgressUpdate(size_t optionIndex, qint64 bytesRece
  */
 void Download::reportNewDataToBeWritten(size_t optionIndex, QIODevice *inputDevice)
 {
+    TRACE_SCOPE("Download::reportNewDataToBeWritten");
     OptionData &optionData = m_optionData[optionIndex];
     optionData.m_stillWriting = true;
     char buffer[1024];
@@ -751,6 +948,7 @@ void Download::reportNewDataToBeWritten(size_t optionIndex, QIODevice *inputDevi
  */
 bool Download::writeBufferToOutputDevice(size_t optionIndex)
 {
+    TRACE_SCOPE("Download::writeBufferToOutputDevice");
     OptionData &optionData = m_optionData[optionIndex];
     streamsize read;
     qint64 written;
@@ -1016,7 +1214,13 @@ void Download::setProgress(qint64 bytesReceived, qint64 bytesToReceive)
 {
     if (m_bytesReceived != bytesReceived || m_bytesToReceive != bytesToReceive) {
         if (bytesReceived > m_bytesReceived && m_time.elapsed()) {
-            m_speed = (static_cast<double>(bytesReceived - m_bytesReceived) * 0.008) / (static_cast<double>(m_time.restart()) * 0.001);
+            m_rateEstimator.addSample(bytesReceived - m_bytesReceived, m_time.restart());
+            m_speed = m_rateEstimator.rate() * 0.008;
+        } else if (bytesReceived < m_bytesReceived) {
+            // a new request has been started
+            m_rateEstimator.reset();
+            m_speed = 0.0;
+            m_time.restart();
         }
         m_bytesReceived = bytesReceived;
         m_bytesToReceive = bytesToReceive;
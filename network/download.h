@@ -2,6 +2,7 @@
 #define DOWNLOAD_H
 
 #include "./downloadrange.h"
+#include "./misc/rateestimator.h"
 #include "./optiondata.h"
 
 #include <c++utilities/chrono/timespan.h>
@@ -13,6 +14,7 @@
 #include <QNetworkProxy>
 #include <QNetworkReply>
 #include <QObject>
+#include <QStringList>
 
 #include <tuple>
 
@@ -35,6 +37,16 @@ enum class DownloadStatus {
     Finished /**< The download has been finished and all received data has been written to the output file. */
 };
 
+/*!
+ * \brief Specifies the priority of a download when initiating and starting downloads automatically.
+ * \sa DownloadScheduler
+ */
+enum class DownloadPriority {
+    Urgent, /**< The download should be processed as soon as possible. */
+    Normal, /**< The default priority. */
+    Background /**< The download should only be processed when there's nothing more important to do. */
+};
+
 class Download : public QObject {
     Q_OBJECT
 public:
@@ -58,12 +70,16 @@ public:
     int progressPercentage() const;
     double speed() const;
     double shiftSpeed();
+    double averageSpeed() const;
+    double shiftAverageSpeed();
     CppUtilities::TimeSpan remainingTime() const;
     CppUtilities::TimeSpan shiftRemainingTime();
     qint64 bytesReceived() const;
     qint64 newBytesReceived();
     qint64 bytesToReceive() const;
     qint64 newBytesToReceive();
+    qint64 expectedSize() const;
+    void probeExpectedSize();
     int lastProgressUpdate() const;
     bool hasStatusInfo() const;
     const QString &statusInfo() const;
@@ -101,6 +117,8 @@ public:
     static void scrambleDefaultUserAgent();
     const QNetworkProxy &proxy() const;
     void setProxy(const QNetworkProxy &value);
+    DownloadPriority priority() const;
+    void setPriority(DownloadPriority priority);
     const QString &uploader() const;
     int views() const;
     CppUtilities::TimeSpan duration() const;
@@ -133,6 +151,8 @@ Q_SIGNALS:
     void statusChanged(Download *download);
     void progressChanged(Download *download);
     void statusInfoChanged(Download *download);
+    void priorityChanged(Download *download);
+    void expectedSizeChanged(Download *download);
     void overwriteingPermissionRequired(Download *download, std::size_t optionIndex, const QString &file);
     void appendingPermissionRequired(Download *download, std::size_t optionIndex, const QString &file, quint64 offset, quint64 fileSize);
     void redirectionPermissonRequired(Download *download, std::size_t optionIndex, int redirectionOptionIndex);
@@ -151,6 +171,7 @@ protected:
     virtual void abortDownload() = 0;
     virtual void doInit() = 0;
     virtual void checkStatusAndClear(std::size_t optionIndex) = 0;
+    virtual void doProbeExpectedSize();
     //  meant to be called by derived classes
     std::size_t addDownloadUrl(const QString &optionName, const QUrl &url, std::size_t redirectionOf = InvalidOptionIndex);
     void changeDownloadUrl(std::size_t optionIndex, const QUrl &value);
@@ -158,6 +179,8 @@ protected:
         bool success, const QString &reasonIfNot = QString(), const QNetworkReply::NetworkError &networkError = QNetworkReply::NoError);
     void reportFinalDownloadStatus(std::size_t optionIndex, bool success, const QString &statusDescription = QString(),
         QNetworkReply::NetworkError networkError = QNetworkReply::NoError);
+    void reportInitiationFailedPermanently(const QString &reason, QNetworkReply::NetworkError networkError = QNetworkReply::NoError);
+    bool reportKnownInitiationFailure();
 protected Q_SLOTS:
     void reportDownloadInterrupted(std::size_t optionIndex);
     void reportNewDataToBeWritten(std::size_t optionIndex, QIODevice *inputDevice);
@@ -176,6 +199,10 @@ protected Q_SLOTS:
     void setPositionInCollection(int value);
     void setCollectionName(const QString &value);
     void reportDownloadProgressUpdate(std::size_t optionIndex, qint64 bytesReceived, qint64 bytesToReceive);
+    void reportReadBufferSize(std::size_t optionIndex, qint64 readBufferSize);
+    void reportTransferPhase(std::size_t optionIndex, TransferTimings::Phase phase);
+    void reportTransferRedirect(std::size_t optionIndex);
+    void reportExpectedSize(qint64 expectedSize);
 
 private:
     // private static methods
@@ -193,6 +220,9 @@ private:
     void setStatusInfo(const QString &value);
     void setStatus(DownloadStatus value);
     void setNetworkError(QNetworkReply::NetworkError value);
+    //  to remember permanent failures
+    QStringList negativeResultCacheKeys() const;
+    void rememberInitiationFailure(const QString &reason, QNetworkReply::NetworkError networkError);
 
     // private fields
 
@@ -222,13 +252,18 @@ private:
     qint64 m_bytesToReceive;
     qint64 m_newBytesReceived;
     qint64 m_newBytesToReceive;
+    qint64 m_expectedSize;
+    bool m_expectedSizeProbed;
     double m_speed;
+    RateEstimator m_rateEstimator;
     double m_shiftSpeed;
+    double m_shiftAverageSpeed;
     CppUtilities::TimeSpan m_shiftRemainingTime;
     QString m_statusInfo;
     QElapsedTimer m_time;
     QNetworkReply::NetworkError m_networkError;
     bool m_initiated;
+    bool m_checkNegativeResultCache;
     int m_progressUpdateInterval;
 
     //  concerning download
@@ -236,6 +271,7 @@ private:
     QString m_userAgent;
     static int s_defaultUserAgent;
     QNetworkProxy m_proxy;
+    DownloadPriority m_priority;
     QString m_targetPath;
     DownloadRange m_range;
 };
@@ -489,6 +525,26 @@ inline void Download::setProxy(const QNetworkProxy &value)
     m_proxy = value;
 }
 
+/*!
+ * \brief Returns the priority (DownloadPriority::Normal by default).
+ */
+inline DownloadPriority Download::priority() const
+{
+    return m_priority;
+}
+
+/*!
+ * \brief Sets the priority.
+ * \remarks The priority only affects the order in which downloads are initiated and started by the DownloadScheduler.
+ */
+inline void Download::setPriority(DownloadPriority priority)
+{
+    if (m_priority != priority) {
+        m_priority = priority;
+        emit priorityChanged(this);
+    }
+}
+
 /*!
  * \brief Returns the name of the uploader if available.
  * \remarks This information is possibly not available before the download is initiated.
@@ -836,7 +892,11 @@ inline int Download::progressPercentage() const
 }
 
 /*!
- * \brief Returns the current speed if available; otherwise 0.
+ * \brief Returns the current speed in kbit/s if available; otherwise 0.
+ *
+ * The speed is an exponentially weighted moving average so it is not affected much by short-term fluctuations.
+ *
+ * \sa RateEstimator
  */
 inline double Download::speed() const
 {
@@ -855,13 +915,40 @@ inline double Download::shiftSpeed()
     return shift;
 }
 
+/*!
+ * \brief Returns the average speed over the last RateEstimator::windowSize progress updates in kbit/s if available; otherwise 0.
+ *
+ * The average over a fixed window reacts to lasting changes of the speed without being biased towards the
+ * last updates so it is used to estimate the remaining time.
+ *
+ * \sa RateEstimator::windowRate()
+ */
+inline double Download::averageSpeed() const
+{
+    return (m_status == DownloadStatus::Downloading && m_rateEstimator.hasRate()) ? m_rateEstimator.windowRate() * 0.008 : 0.0;
+}
+
+/*!
+ * \brief Returns the alteration of the average speed since the last call of this method.
+ * \sa averageSpeed()
+ */
+inline double Download::shiftAverageSpeed()
+{
+    double absolute = averageSpeed();
+    double shift = absolute - m_shiftAverageSpeed;
+    m_shiftAverageSpeed = absolute;
+    return shift;
+}
+
 /*!
  * \brief Returns the estimated remaining time.
+ * \remarks The estimation is based on averageSpeed().
  */
 inline CppUtilities::TimeSpan Download::remainingTime() const
 {
-    return (m_status == DownloadStatus::Downloading && m_bytesToReceive != -1)
-        ? CppUtilities::TimeSpan::fromSeconds(static_cast<double>(m_bytesToReceive) / (m_speed * 125.0))
+    const double averageSpeed = this->averageSpeed();
+    return (m_bytesToReceive != -1 && averageSpeed > 0.0)
+        ? CppUtilities::TimeSpan::fromSeconds(static_cast<double>(m_bytesToReceive - m_bytesReceived) / (averageSpeed * 125.0))
         : CppUtilities::TimeSpan();
 }
 
@@ -916,6 +1003,17 @@ inline qint64 Download::newBytesToReceive()
     return shift;
 }
 
+/*!
+ * \brief Returns the expected total number of bytes to receive or -1 if unknown.
+ *
+ * Before the actual download has been started the size is only known if it has been determined via
+ * probeExpectedSize() or during the initialization.
+ */
+inline qint64 Download::expectedSize() const
+{
+    return m_bytesToReceive > 0 ? m_bytesToReceive : m_expectedSize;
+}
+
 /*!
  * \brief Returns the number of milliseconds since the last progress update.
  */
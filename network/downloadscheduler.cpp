@@ -0,0 +1,377 @@
+#include "./downloadscheduler.h"
+#include "./download.h"
+
+#include <limits>
+
+namespace Network {
+
+/*!
+ * \class DownloadScheduler
+ * \brief The DownloadScheduler class initiates and starts downloads automatically.
+ *
+ * Added downloads are kept in queues: downloads which still need to be initiated (status
+ * DownloadStatus::None) and downloads which are ready to be started (status DownloadStatus::Ready).
+ * The queues are updated when the status of a download changes so no list of downloads needs to be scanned.
+ *
+ * Initiating and downloading have separate budgets. Whenever the number of downloading downloads drops
+ * below maxConcurrentDownloads() the next ready download is started. Downloads are initiated in advance
+ * so that initiationLookAhead() downloads are ready (or being initiated) in addition to the ones needed
+ * to fill the free download slots. This way a free slot can be filled immediately without waiting for
+ * the initialization. Not more than maxConcurrentInitiations() downloads are initiated at the same time.
+ *
+ * There are separate queues for each DownloadPriority. Free slots are shared between the priorities
+ * using stride scheduling: as long as downloads of all priorities are waiting, urgent downloads get three
+ * times as many slots as normal downloads and normal downloads get four times as many slots as background
+ * downloads. Within a priority, the hosts are served in a round-robin fashion so a large batch of downloads
+ * from one host does not block downloads from other hosts.
+ *
+ * In Mode::ShortestFirst ready downloads are started in the order of their remaining bytes instead, so
+ * small downloads are not stuck behind large ones and the mean completion time is minimized. Downloads of
+ * a higher priority are still started first. The size of a ready download is probed (see
+ * Download::probeExpectedSize()) if not known yet; downloads of unknown size are started last. To ensure
+ * large downloads still make progress, a download which has been waiting longer than maxWaitTime() is
+ * started next regardless of its size. A larger initiationLookAhead() gives this mode more downloads to
+ * choose from.
+ *
+ * By default the max. number of concurrent downloads is zero so downloads are not initiated or started
+ * automatically at all.
+ */
+
+/*!
+ * \brief The strides of the priorities (inversely proportional to their share of the slots).
+ */
+constexpr std::array<quint64, 3> priorityStrides = { 1, 3, 12 };
+
+/*!
+ * \brief Constructs a new scheduler.
+ */
+DownloadScheduler::DownloadScheduler(QObject *parent)
+    : QObject(parent)
+    , m_mode(Mode::Fair)
+    , m_maxWaitTime(10 * 60 * 1000)
+    , m_maxConcurrentDownloads(0)
+    , m_maxConcurrentInitiations(4)
+    , m_initiationLookAhead(2)
+    , m_activeDownloads(0)
+    , m_initiatingDownloads(0)
+    , m_scheduling(false)
+{
+    m_clock.start();
+}
+
+/*!
+ * \brief Sets the order in which ready downloads are started.
+ */
+void DownloadScheduler::setMode(Mode mode)
+{
+    if (m_mode == mode) {
+        return;
+    }
+    m_mode = mode;
+    if (m_mode == Mode::ShortestFirst) {
+        for (const auto &readyDownload : m_readyOrder) {
+            readyDownload.second->probeExpectedSize();
+        }
+    }
+    schedule();
+}
+
+/*!
+ * \brief Sets the max. number of downloads which are downloading at the same time.
+ * \remarks
+ * - Downloads which are already downloading are not stopped when lowering the value.
+ * - If the value is zero, downloads are neither started nor initiated automatically.
+ */
+void DownloadScheduler::setMaxConcurrentDownloads(int maxConcurrentDownloads)
+{
+    m_maxConcurrentDownloads = maxConcurrentDownloads;
+    schedule();
+}
+
+/*!
+ * \brief Sets the max. number of downloads which are initiated at the same time.
+ */
+void DownloadScheduler::setMaxConcurrentInitiations(int maxConcurrentInitiations)
+{
+    m_maxConcurrentInitiations = maxConcurrentInitiations;
+    schedule();
+}
+
+/*!
+ * \brief Sets the number of downloads which are initiated in advance.
+ */
+void DownloadScheduler::setInitiationLookAhead(int initiationLookAhead)
+{
+    m_initiationLookAhead = initiationLookAhead;
+    schedule();
+}
+
+/*!
+ * \brief Adds the specified \a download to the scheduler.
+ *
+ * The scheduler does not take ownership. Does nothing if the download has already been added.
+ */
+void DownloadScheduler::addDownload(Download *download)
+{
+    if (m_entries.contains(download)) {
+        return;
+    }
+    connect(download, &Download::statusChanged, this, &DownloadScheduler::downloadChangedStatus);
+    connect(download, &Download::priorityChanged, this, &DownloadScheduler::downloadChangedStatus);
+    connect(download, &Download::expectedSizeChanged, this, &DownloadScheduler::downloadChangedStatus);
+    connect(download, &QObject::destroyed, this, &DownloadScheduler::downloadDestroyed);
+    enqueue(download, m_entries[download] = Entry{ Queue::None, 0, QString(), {}, {}, {}, -1 });
+    schedule();
+}
+
+/*!
+ * \brief Removes the specified \a download from the scheduler.
+ */
+void DownloadScheduler::removeDownload(Download *download)
+{
+    const auto entry = m_entries.find(download);
+    if (entry == m_entries.end()) {
+        return;
+    }
+    download->disconnect(this);
+    dequeue(*entry);
+    m_entries.erase(entry);
+    schedule();
+}
+
+/*!
+ * \brief Initiates or starts downloads until the max. number of concurrent downloads is reached.
+ *
+ * This method is called automatically when needed. Calling it while it is already running (e.g. because
+ * initiating a download changes its status) has no effect.
+ */
+void DownloadScheduler::schedule()
+{
+    if (m_scheduling) {
+        return;
+    }
+    m_scheduling = true;
+    for (;;) {
+        // fill free download slots with ready downloads first, then initiate further downloads
+        const auto start = m_activeDownloads < m_maxConcurrentDownloads && m_startQueues.size;
+        if (!start && !canInitiate()) {
+            break;
+        }
+        Download *const download
+            = start ? (m_mode == Mode::ShortestFirst ? takeShortest() : takeNext(m_startQueues)) : takeNext(m_initQueues);
+        if (m_preparator) {
+            m_preparator(download);
+        }
+        if (start) {
+            download->start();
+        } else {
+            download->init();
+        }
+    }
+    m_scheduling = false;
+}
+
+/*!
+ * \brief Moves the specified \a download to the queue according to its new status, priority and expected size.
+ */
+void DownloadScheduler::downloadChangedStatus(Download *download)
+{
+    const auto entry = m_entries.find(download);
+    if (entry == m_entries.end()) {
+        return;
+    }
+    // keep the waiting time of a ready download when only its priority or expected size changes
+    const auto readySince = entry->queue == Queue::Start && download->status() == DownloadStatus::Ready ? entry->readySince : -1;
+    dequeue(*entry);
+    entry->readySince = readySince;
+    enqueue(download, *entry);
+    schedule();
+}
+
+/*!
+ * \brief Forgets the specified \a download when it has been destroyed.
+ * \remarks The download must not be accessed here anymore because it is already partially destroyed.
+ */
+void DownloadScheduler::downloadDestroyed(QObject *download)
+{
+    const auto entry = m_entries.find(static_cast<Download *>(download));
+    if (entry == m_entries.end()) {
+        return;
+    }
+    dequeue(*entry);
+    m_entries.erase(entry);
+    schedule();
+}
+
+/*!
+ * \brief Returns the host the specified \a download is assigned to for round-robin scheduling.
+ */
+QString DownloadScheduler::hostOf(Download *download)
+{
+    const auto host = download->initialUrl().host();
+    return host.isEmpty() ? download->typeName() : host;
+}
+
+/*!
+ * \brief Returns whether a further download should be initiated.
+ */
+bool DownloadScheduler::canInitiate() const
+{
+    if (!m_initQueues.size || m_maxConcurrentDownloads <= 0 || m_initiatingDownloads >= m_maxConcurrentInitiations) {
+        return false;
+    }
+    const auto freeSlots = qMax(m_maxConcurrentDownloads - m_activeDownloads, 0);
+    return m_initiatingDownloads + m_startQueues.size < freeSlots + m_initiationLookAhead;
+}
+
+/*!
+ * \brief Adds the specified \a download to the queue which corresponds to its status and priority.
+ * \remarks The download must not be enqueued yet.
+ */
+void DownloadScheduler::enqueue(Download *download, Entry &entry)
+{
+    switch (download->status()) {
+    case DownloadStatus::None:
+        entry.queue = Queue::Init;
+        break;
+    case DownloadStatus::Ready:
+        entry.queue = Queue::Start;
+        break;
+    case DownloadStatus::Initiating:
+        entry.queue = Queue::Initiating;
+        ++m_initiatingDownloads;
+        return;
+    case DownloadStatus::Downloading:
+        entry.queue = Queue::Active;
+        ++m_activeDownloads;
+        return;
+    default:
+        entry.queue = Queue::None;
+        return;
+    }
+
+    entry.priority = static_cast<std::size_t>(download->priority());
+    entry.host = hostOf(download);
+    auto &queueSet = entry.queue == Queue::Start ? m_startQueues : m_initQueues;
+    auto &priorityQueue = queueSet.priorities[entry.priority];
+    // don't let a priority which has been idle catch up with the others
+    if (!priorityQueue.size) {
+        priorityQueue.pass = qMax(priorityQueue.pass, queueSet.virtualTime);
+    }
+    auto hostQueue = priorityQueue.hosts.find(entry.host);
+    if (hostQueue == priorityQueue.hosts.end()) {
+        hostQueue = priorityQueue.hosts.insert(entry.host, HostQueue());
+        hostQueue->ringPosition = priorityQueue.hostRing.insert(priorityQueue.hostRing.end(), entry.host);
+    }
+    entry.position = hostQueue->downloads.insert(hostQueue->downloads.end(), download);
+    ++priorityQueue.size;
+    ++queueSet.size;
+
+    if (entry.queue != Queue::Start) {
+        return;
+    }
+    // keep ready downloads also ordered by their remaining bytes and the time they're waiting for Mode::ShortestFirst
+    const auto expectedSize = download->expectedSize();
+    const auto remainingBytes
+        = expectedSize >= 0 ? qMax<qint64>(expectedSize - qMax<qint64>(download->bytesReceived(), 0), 0) : std::numeric_limits<qint64>::max();
+    entry.sizePosition = m_sizeOrder.emplace(SizeKey(entry.priority, remainingBytes), download);
+    if (entry.readySince < 0) {
+        entry.readySince = m_clock.elapsed();
+    }
+    entry.readyPosition = m_readyOrder.emplace(entry.readySince, download);
+    if (m_mode == Mode::ShortestFirst && expectedSize < 0) {
+        download->probeExpectedSize();
+    }
+}
+
+/*!
+ * \brief Removes the download with the specified \a entry from its queue.
+ */
+void DownloadScheduler::dequeue(Entry &entry)
+{
+    switch (entry.queue) {
+    case Queue::Init:
+    case Queue::Start:
+        break;
+    case Queue::Initiating:
+        --m_initiatingDownloads;
+        entry.queue = Queue::None;
+        return;
+    case Queue::Active:
+        --m_activeDownloads;
+        [[fallthrough]];
+    default:
+        entry.queue = Queue::None;
+        return;
+    }
+
+    auto &queueSet = entry.queue == Queue::Start ? m_startQueues : m_initQueues;
+    auto &priorityQueue = queueSet.priorities[entry.priority];
+    const auto hostQueue = priorityQueue.hosts.find(entry.host);
+    hostQueue->downloads.erase(entry.position);
+    if (hostQueue->downloads.empty()) {
+        priorityQueue.hostRing.erase(hostQueue->ringPosition);
+        priorityQueue.hosts.erase(hostQueue);
+    }
+    --priorityQueue.size;
+    --queueSet.size;
+    if (entry.queue == Queue::Start) {
+        m_sizeOrder.erase(entry.sizePosition);
+        m_readyOrder.erase(entry.readyPosition);
+        entry.readySince = -1;
+    }
+    entry.queue = Queue::None;
+}
+
+/*!
+ * \brief Takes the next download out of the specified \a queueSet.
+ *
+ * The priority is picked via stride scheduling. The download is taken from the host which is next in turn
+ * and the host is moved to the end of the round-robin order afterwards.
+ *
+ * \remarks The \a queueSet must not be empty.
+ */
+Download *DownloadScheduler::takeNext(QueueSet &queueSet)
+{
+    // pick the priority with the lowest pass among the priorities with waiting downloads
+    PriorityQueue *priorityQueue = nullptr;
+    std::size_t priority = 0;
+    for (std::size_t i = 0; i != priorityCount; ++i) {
+        auto &candidate = queueSet.priorities[i];
+        if (candidate.size && (!priorityQueue || candidate.pass < priorityQueue->pass)) {
+            priorityQueue = &candidate;
+            priority = i;
+        }
+    }
+    queueSet.virtualTime = priorityQueue->pass;
+    priorityQueue->pass += priorityStrides[priority];
+
+    const auto host = priorityQueue->hostRing.front();
+    Download *const download = priorityQueue->hosts[host].downloads.front();
+    // take the download out of the queue so it is not picked again if its status doesn't change
+    dequeue(m_entries[download]);
+    // move host to the end of the round-robin order if it has still downloads
+    const auto hostQueue = priorityQueue->hosts.find(host);
+    if (hostQueue != priorityQueue->hosts.end()) {
+        priorityQueue->hostRing.splice(priorityQueue->hostRing.end(), priorityQueue->hostRing, hostQueue->ringPosition);
+    }
+    return download;
+}
+
+/*!
+ * \brief Takes the ready download with the least remaining bytes out of the start queues.
+ *
+ * A download which has been waiting longer than maxWaitTime() is taken instead so large downloads are not
+ * starved by a steady stream of small ones.
+ *
+ * \remarks The start queues must not be empty.
+ */
+Download *DownloadScheduler::takeShortest()
+{
+    const auto longestWaiting = m_readyOrder.begin();
+    Download *const download = m_clock.elapsed() - longestWaiting->first >= m_maxWaitTime ? longestWaiting->second : m_sizeOrder.begin()->second;
+    dequeue(m_entries[download]);
+    return download;
+}
+
+} // namespace Network
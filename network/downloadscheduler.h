@@ -0,0 +1,226 @@
+#ifndef NETWORK_DOWNLOADSCHEDULER_H
+#define NETWORK_DOWNLOADSCHEDULER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QString>
+
+#include <array>
+#include <functional>
+#include <list>
+#include <map>
+#include <utility>
+
+namespace Network {
+
+class Download;
+
+class DownloadScheduler : public QObject {
+    Q_OBJECT
+
+public:
+    using Preparator = std::function<void(Download *)>;
+
+    /*!
+     * \brief Specifies the order in which ready downloads are started.
+     */
+    enum class Mode {
+        Fair, /**< Priorities share the slots via stride scheduling and hosts are served in a round-robin fashion. */
+        ShortestFirst /**< Downloads with the least remaining bytes are started first (within the same priority). */
+    };
+
+    explicit DownloadScheduler(QObject *parent = nullptr);
+
+    Mode mode() const;
+    void setMode(Mode mode);
+    int maxWaitTime() const;
+    void setMaxWaitTime(int maxWaitTime);
+    int maxConcurrentDownloads() const;
+    int maxConcurrentInitiations() const;
+    void setMaxConcurrentInitiations(int maxConcurrentInitiations);
+    int initiationLookAhead() const;
+    void setInitiationLookAhead(int initiationLookAhead);
+    const Preparator &preparator() const;
+    void setPreparator(const Preparator &preparator);
+    int activeDownloads() const;
+    int initiatingDownloads() const;
+    int downloadsToInit() const;
+    int downloadsToStart() const;
+    bool contains(Download *download) const;
+    void addDownload(Download *download);
+    void removeDownload(Download *download);
+
+public Q_SLOTS:
+    void setMaxConcurrentDownloads(int maxConcurrentDownloads);
+    void schedule();
+
+private Q_SLOTS:
+    void downloadChangedStatus(Download *download);
+    void downloadDestroyed(QObject *download);
+
+private:
+    static constexpr std::size_t priorityCount = 3;
+    enum class Queue { None, Init, Start, Initiating, Active };
+    struct HostQueue {
+        std::list<Download *> downloads;
+        std::list<QString>::iterator ringPosition;
+    };
+    struct PriorityQueue {
+        QHash<QString, HostQueue> hosts;
+        std::list<QString> hostRing;
+        std::size_t size = 0;
+        quint64 pass = 0;
+    };
+    struct QueueSet {
+        std::array<PriorityQueue, priorityCount> priorities;
+        quint64 virtualTime = 0;
+        int size = 0;
+    };
+    using SizeKey = std::pair<std::size_t, qint64>;
+    struct Entry {
+        Queue queue;
+        std::size_t priority;
+        QString host;
+        std::list<Download *>::iterator position;
+        std::multimap<SizeKey, Download *>::iterator sizePosition;
+        std::multimap<qint64, Download *>::iterator readyPosition;
+        qint64 readySince;
+    };
+
+    static QString hostOf(Download *download);
+    void enqueue(Download *download, Entry &entry);
+    void dequeue(Entry &entry);
+    Download *takeNext(QueueSet &queueSet);
+    Download *takeShortest();
+    bool canInitiate() const;
+
+    QueueSet m_initQueues;
+    QueueSet m_startQueues;
+    std::multimap<SizeKey, Download *> m_sizeOrder;
+    std::multimap<qint64, Download *> m_readyOrder;
+    QHash<Download *, Entry> m_entries;
+    QElapsedTimer m_clock;
+    Preparator m_preparator;
+    Mode m_mode;
+    int m_maxWaitTime;
+    int m_maxConcurrentDownloads;
+    int m_maxConcurrentInitiations;
+    int m_initiationLookAhead;
+    int m_activeDownloads;
+    int m_initiatingDownloads;
+    bool m_scheduling;
+};
+
+/*!
+ * \brief Returns the order in which ready downloads are started (Mode::Fair by default).
+ */
+inline DownloadScheduler::Mode DownloadScheduler::mode() const
+{
+    return m_mode;
+}
+
+/*!
+ * \brief Returns the max. number of milliseconds a ready download waits in Mode::ShortestFirst before it is
+ *        started regardless of its size.
+ */
+inline int DownloadScheduler::maxWaitTime() const
+{
+    return m_maxWaitTime;
+}
+
+/*!
+ * \brief Sets the max. number of milliseconds a ready download waits in Mode::ShortestFirst before it is
+ *        started regardless of its size.
+ */
+inline void DownloadScheduler::setMaxWaitTime(int maxWaitTime)
+{
+    m_maxWaitTime = maxWaitTime;
+}
+
+/*!
+ * \brief Returns the max. number of downloads which are downloading at the same time.
+ */
+inline int DownloadScheduler::maxConcurrentDownloads() const
+{
+    return m_maxConcurrentDownloads;
+}
+
+/*!
+ * \brief Returns the max. number of downloads which are initiated at the same time.
+ */
+inline int DownloadScheduler::maxConcurrentInitiations() const
+{
+    return m_maxConcurrentInitiations;
+}
+
+/*!
+ * \brief Returns the number of downloads which are initiated in advance so they can be started immediately
+ *        when a download finishes.
+ */
+inline int DownloadScheduler::initiationLookAhead() const
+{
+    return m_initiationLookAhead;
+}
+
+/*!
+ * \brief Returns the function which is called before a download is initiated or started.
+ */
+inline const DownloadScheduler::Preparator &DownloadScheduler::preparator() const
+{
+    return m_preparator;
+}
+
+/*!
+ * \brief Sets the function which is called before a download is initiated or started.
+ *
+ * Might be used to apply the current settings to the download.
+ */
+inline void DownloadScheduler::setPreparator(const Preparator &preparator)
+{
+    m_preparator = preparator;
+}
+
+/*!
+ * \brief Returns the number of downloads which are currently downloading.
+ */
+inline int DownloadScheduler::activeDownloads() const
+{
+    return m_activeDownloads;
+}
+
+/*!
+ * \brief Returns the number of downloads which are currently initiating.
+ */
+inline int DownloadScheduler::initiatingDownloads() const
+{
+    return m_initiatingDownloads;
+}
+
+/*!
+ * \brief Returns the number of downloads which are waiting to be initiated.
+ */
+inline int DownloadScheduler::downloadsToInit() const
+{
+    return m_initQueues.size;
+}
+
+/*!
+ * \brief Returns the number of downloads which are ready and waiting to be started.
+ */
+inline int DownloadScheduler::downloadsToStart() const
+{
+    return m_startQueues.size;
+}
+
+/*!
+ * \brief Returns whether the specified \a download has been added to the scheduler.
+ */
+inline bool DownloadScheduler::contains(Download *download) const
+{
+    return m_entries.contains(download);
+}
+
+} // namespace Network
+
+#endif // NETWORK_DOWNLOADSCHEDULER_H
@@ -1,11 +1,9 @@
 #include "./filenukedownload.h"
 
-#include "../application/utils.h"
+#include "./misc/textscanner.h"
 
 #include <QUrlQuery>
 
-using namespace Application;
-
 namespace Network {
 
 /*!
@@ -25,19 +23,31 @@ FileNukeDownload::FileNukeDownload(const QUrl &url, QObject *parent)
 
 void FileNukeDownload::evalVideoInformation(Download *, QBuffer *videoInfoBuffer)
 {
+    static const QStringMatcher quoteMarker(QStringLiteral("\""));
+    static const QStringMatcher titleMarker(QStringLiteral("<h1>"));
+    static const QStringMatcher titleEndMarker(QStringLiteral("<"));
+    static const QStringMatcher idMarker(QStringLiteral("<input type=\"hidden\" name=\"id\" value=\""));
+    static const QStringMatcher fileNameMarker(QStringLiteral("<input type=\"hidden\" name=\"fname\" value=\""));
+    static const QStringMatcher packedScriptMarker(QStringLiteral(";return p}("));
+    static const QStringMatcher packedArgumentsMarker(QStringLiteral(",'"));
+    static const QStringMatcher singleQuoteMarker(QStringLiteral("'"));
+
     videoInfoBuffer->seek(0);
-    QString videoInfo(videoInfoBuffer->readAll());
-    int pos;
+    const QString videoInfo(videoInfoBuffer->readAll());
+    TextScanner scanner(videoInfo);
     QString str;
     QString id;
     QString fname;
     switch (m_currentStep) {
     case 0:
-        if (substring(videoInfo, str, 0, QStringLiteral("<h1>"), QStringLiteral("<")) > 0 && !str.isEmpty()) {
+        if (scanner.extract(titleMarker, titleEndMarker, str) && !str.isEmpty()) {
             setTitle(str);
         }
-        substring(videoInfo, id, 0, QStringLiteral("<input type=\"hidden\" name=\"id\" value=\""), QStringLiteral("\""));
-        substring(videoInfo, fname, 0, QStringLiteral("<input type=\"hidden\" name=\"fname\" value=\""), QStringLiteral("\""));
+        // the hidden fields of the form might be in any order
+        scanner.setPosition(0);
+        scanner.extract(idMarker, quoteMarker, id);
+        scanner.setPosition(0);
+        scanner.extract(fileNameMarker, quoteMarker, fname);
         if (id.isEmpty()) {
             reportInitiated(false, tr("Couldn't find the id."));
         } else if (fname.isEmpty()) {
@@ -56,11 +66,9 @@ void FileNukeDownload::evalVideoInformation(Download *, QBuffer *videoInfoBuffer
         }
         break;
     case 1:
-        pos = videoInfo.indexOf(QLatin1String(";return p}("));
-        if (pos > 0) {
-            pos = videoInfo.indexOf(QLatin1String(",'"), pos + 1);
-            if (pos > 0) {
-                substring(videoInfo, str, pos, QStringLiteral("'"), QStringLiteral("'"));
+        if (scanner.skipPast(packedScriptMarker)) {
+            if (scanner.skipTo(packedArgumentsMarker)) {
+                scanner.extract(singleQuoteMarker, singleQuoteMarker, str);
                 QStringList parts = str.split(QChar('|'), Qt::KeepEmptyParts);
 
                 if (parts.count() >= 21) {
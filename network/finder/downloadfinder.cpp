@@ -2,6 +2,11 @@
 
 #include "../download.h"
 
+#include "../../application/tracing.h"
+
+#include <algorithm>
+#include <vector>
+
 namespace Network {
 
 /*!
@@ -14,9 +19,18 @@ namespace Network {
  */
 DownloadFinder::DownloadFinder(QObject *parent)
     : QObject(parent)
+    , m_parsedBytes(0)
+    , m_parsingIncrementally(false)
     , m_resultCount(0)
     , m_continueAutomatically(true)
     , m_finished(false)
+    , m_parsingFollowUpRequest(nullptr)
+    , m_runningFollowUpRequests(0)
+    , m_maxConcurrentRequests(4)
+    , m_maxFollowUpResponseSize(0)
+    , m_followUpRequestsAdded(false)
+    , m_waitingForFollowUpRequests(false)
+    , m_followUpRequestSucceeded(false)
 {
 }
 
@@ -25,30 +39,35 @@ DownloadFinder::DownloadFinder(QObject *parent)
  */
 DownloadFinder::~DownloadFinder()
 {
+    abortFollowUpRequests();
     stop();
 }
 
 /*!
  * \brief Returns whether the finder is downloading.
+ * \remarks Also returns true while follow-up requests (see addFollowUpRequest()) are running.
  */
 bool DownloadFinder::isDownloading() const
 {
-    return m_download && (m_download->status() == DownloadStatus::Downloading || m_download->status() == DownloadStatus::Initiating);
+    return !m_followUpRequests.empty() || (m_download && (m_download->status() == DownloadStatus::Downloading || m_download->status() == DownloadStatus::Initiating));
 }
 
 /*!
  * \brief Returns the download from the results which has the specified initial URL.
  * \returns Returns a pointer to the download (ownership remains by the finder) or nullptr
  *          if no download has been found.
+ * \remarks
+ * - The URLs are compared in their normalized form (see normalizedUrl()).
+ * - Results of follow-up requests which are still kept back (see reportResult()) are considered as well
+ *   so subclasses can use this function to avoid reporting duplicates.
  */
 Download *DownloadFinder::downloadByInitialUrl(const QUrl &url) const
 {
-    for (Download *download : m_results) {
-        if (download->initialUrl() == url) {
-            return download;
-        }
+    const QUrl normalized = normalizedUrl(url);
+    if (Download *const result = m_resultsByInitialUrl.value(normalized, nullptr)) {
+        return result;
     }
-    return nullptr;
+    return m_heldBackResultsByInitialUrl.value(normalized, nullptr);
 }
 
 /*!
@@ -58,14 +77,7 @@ Download *DownloadFinder::downloadByInitialUrl(const QUrl &url) const
  */
 bool DownloadFinder::hasDownloadUrl(const QUrl &url) const
 {
-    for (const Download *download : m_results) {
-        for (const OptionData &option : download->options()) {
-            if (option.url() == url) {
-                return true;
-            }
-        }
-    }
-    return false;
+    return m_downloadUrls.contains(normalizedUrl(url));
 }
 
 /*!
@@ -101,17 +113,23 @@ bool DownloadFinder::start()
 }
 
 /*!
- * \brief Stops searching.
+ * \brief Stops searching; follow-up requests are aborted.
  */
 void DownloadFinder::stop()
 {
     if (m_download) {
         m_download->stop();
     }
+    const bool waitingForFollowUpRequests = m_waitingForFollowUpRequests;
+    abortFollowUpRequests();
+    if (waitingForFollowUpRequests) {
+        emitNewResultsSignal();
+        emitFinishedSignal(false, tr("The search has been aborted."));
+    }
 }
 
 /*!
- * \brief Reports the collection title.
+ * \brief Reports the specified \a result.
  *
  * Should be called when subclassing to propagate results.
  */
@@ -119,7 +137,52 @@ void DownloadFinder::reportResult(Download *result)
 {
     result->setParent(this);
     result->setProxy(m_proxy);
+    if (m_parsingFollowUpRequest) {
+        // keep results of follow-up requests back until the previously added requests are done
+        m_parsingFollowUpRequest->results << result;
+        Download *&heldBackResultWithSameUrl = m_heldBackResultsByInitialUrl[normalizedUrl(result->initialUrl())];
+        if (!heldBackResultWithSameUrl) {
+            heldBackResultWithSameUrl = result;
+        }
+    } else {
+        insertResult(result);
+    }
+}
+
+/*!
+ * \brief Adds the specified \a request to the requests which are run after the initial request.
+ *
+ * Can be called when subclassing (eg. from parseResults() or parseChunk()) to fetch several independent pages of
+ * the results. The requests are run in parallel; at most maxConcurrentRequests() at the same time. Their responses
+ * are passed to parseFollowUpResults() which might add further follow-up requests. The search is finished after
+ * the initial request and all follow-up requests are done. It is considered successful if at least one of the
+ * follow-up requests succeeded or results have been found anyways.
+ *
+ * The finder takes ownership of the \a request.
+ */
+void DownloadFinder::addFollowUpRequest(Download *request)
+{
+    request->setParent(this);
+    request->setProxy(m_proxy);
+    m_followUpRequestsAdded = true;
+    m_followUpRequests.emplace_back();
+    m_followUpRequests.back().download = request;
+    startFollowUpRequests();
+}
+
+/*!
+ * \brief Adds the specified \a result to the results and the indices used to detect duplicates.
+ */
+void DownloadFinder::insertResult(Download *result)
+{
     m_results << result;
+    Download *&resultWithSameUrl = m_resultsByInitialUrl[normalizedUrl(result->initialUrl())];
+    if (!resultWithSameUrl) {
+        resultWithSameUrl = result;
+    }
+    // download URLs are only known after initialization
+    indexDownloadUrls(result);
+    connect(result, &Download::statusChanged, this, &DownloadFinder::indexDownloadUrls);
 }
 
 /*!
@@ -133,27 +196,53 @@ void DownloadFinder::downloadChangedStatus(Download *download)
         if (finalizeRequest(download, reasonForFail)) {
             download->start();
         } else {
+            abortFollowUpRequests();
             emitFinishedSignal(false, reasonForFail);
         }
         break;
     }
     case DownloadStatus::Failed:
+        // follow-up requests might have been added while the response was parsed incrementally
+        abortFollowUpRequests();
         emitFinishedSignal(false, download->statusInfo());
         break;
     case DownloadStatus::Finished:
         if (!m_buffer) {
             emitFinishedSignal(false, tr("The buffer hasn't been initialized correctly."));
         } else {
+            if (m_parsingIncrementally && m_parsedBytes < m_buffer->data().size()) {
+                // pass the rest which has been written since the last chunk was parsed
+                TRACE_SCOPE("DownloadFinder::parseChunk");
+                parseChunk(m_buffer->data().constData() + m_parsedBytes, static_cast<std::size_t>(m_buffer->data().size() - m_parsedBytes));
+            }
             m_buffer->seek(0);
             QByteArray data = m_buffer->readAll();
             m_buffer.reset();
+            m_parsingIncrementally = false;
             QString reasonForFail;
-            switch (parseResults(data, reasonForFail)) {
+            ParsingResult result;
+            {
+                TRACE_SCOPE("DownloadFinder::parseResults");
+                result = parseResults(data, reasonForFail);
+            }
+            switch (result) {
             case ParsingResult::Error:
+                abortFollowUpRequests();
                 m_finished = true;
                 emitFinishedSignal(false, reasonForFail);
                 break;
             case ParsingResult::Success:
+                if (m_followUpRequestsAdded) {
+                    emitNewResultsSignal();
+                    if (!m_followUpRequests.empty()) {
+                        // finish when all follow-up requests are done (see finishFollowUpRequest())
+                        m_waitingForFollowUpRequests = true;
+                    } else {
+                        // all follow-up requests are already done, eg. because they failed immediately
+                        emitFollowUpRequestsFinishedSignal();
+                    }
+                    break;
+                }
                 m_finished = true;
                 emitNewResultsSignal();
                 emitFinishedSignal(true, reasonForFail);
@@ -173,16 +262,230 @@ void DownloadFinder::downloadChangedStatus(Download *download)
     }
 }
 
+/*!
+ * \brief Provides the buffer the response of the current request is written to.
+ */
 void DownloadFinder::downloadRequiresOutputDevice(Download *download, size_t option)
 {
     m_buffer.reset(new QBuffer);
+    m_parsedBytes = 0;
+    m_parsingIncrementally = beginIncrementalParsing();
     if (m_buffer->open(QIODevice::ReadWrite)) {
+        if (m_parsingIncrementally) {
+            // QBuffer emits bytesWritten() once per event loop iteration so chunks are parsed in batches
+            connect(m_buffer.get(), &QBuffer::bytesWritten, this, &DownloadFinder::parseAvailableData);
+        }
         download->provideOutputDevice(option, m_buffer.get(), false);
     } else {
         download->provideOutputDevice(option, nullptr);
     }
 }
 
+/*!
+ * \brief Passes the data which has been written to the buffer since the last call to parseChunk() and
+ *        makes the results found so far available.
+ * \remarks The buffer is not read via the QIODevice interface because the download writes at the current position.
+ */
+void DownloadFinder::parseAvailableData()
+{
+    if (!m_buffer || !m_parsingIncrementally) {
+        return;
+    }
+    const QByteArray &data = m_buffer->data();
+    if (data.size() <= m_parsedBytes) {
+        return;
+    }
+    {
+        TRACE_SCOPE("DownloadFinder::parseChunk");
+        parseChunk(data.constData() + m_parsedBytes, static_cast<std::size_t>(data.size() - m_parsedBytes));
+    }
+    m_parsedBytes = data.size();
+    emitNewResultsSignal();
+}
+
+/*!
+ * \brief Starts follow-up requests until the max. number of concurrent requests is reached.
+ */
+void DownloadFinder::startFollowUpRequests()
+{
+    const auto maxConcurrentRequests = std::max(m_maxConcurrentRequests, 1);
+    std::vector<Download *> requestsToInit;
+    for (FollowUpRequest &request : m_followUpRequests) {
+        if (m_runningFollowUpRequests >= maxConcurrentRequests) {
+            break;
+        }
+        if (request.started) {
+            continue;
+        }
+        request.started = true;
+        ++m_runningFollowUpRequests;
+        Download *const download = request.download;
+        connect(download, &Download::statusChanged, this, [this, &request] { followUpRequestChangedStatus(request); });
+        emit requestCreated(download);
+        // ensure the output device is only provided by the the finder
+        disconnect(download, &Download::outputDeviceRequired, nullptr, nullptr);
+        connect(download, &Download::outputDeviceRequired, this, [this, &request](Download *concerningDownload, std::size_t option) {
+            if (!request.buffer) {
+                // the buffer is deleted together with the request
+                request.buffer = new QBuffer(concerningDownload);
+                request.buffer->open(QIODevice::ReadWrite);
+                if (m_maxFollowUpResponseSize > 0) {
+                    connect(request.buffer, &QBuffer::bytesWritten, this, [this, &request] {
+                        if (request.buffer->size() > m_maxFollowUpResponseSize) {
+                            request.download->disconnect(this);
+                            request.download->stop();
+                            finishFollowUpRequest(request, false, tr("The response exceeds the max. size of %1 bytes.").arg(m_maxFollowUpResponseSize));
+                        }
+                    });
+                }
+            }
+            concerningDownload->provideOutputDevice(option, request.buffer->isOpen() ? request.buffer : nullptr, false);
+        });
+        requestsToInit.emplace_back(download);
+    }
+    // init the requests after iterating because a request might be done immediately
+    for (Download *const download : requestsToInit) {
+        download->init();
+    }
+}
+
+/*!
+ * \brief Handles a changed status of the specified follow-up \a request.
+ */
+void DownloadFinder::followUpRequestChangedStatus(FollowUpRequest &request)
+{
+    switch (request.download->status()) {
+    case DownloadStatus::Ready: {
+        QString reasonForFail;
+        if (finalizeRequest(request.download, reasonForFail)) {
+            request.download->start();
+        } else {
+            finishFollowUpRequest(request, false, reasonForFail);
+        }
+        break;
+    }
+    case DownloadStatus::Failed:
+        finishFollowUpRequest(request, false, request.download->statusInfo());
+        break;
+    case DownloadStatus::Finished: {
+        if (!request.buffer) {
+            finishFollowUpRequest(request, false, tr("The buffer hasn't been initialized correctly."));
+            break;
+        }
+        QString reasonForFail;
+        ParsingResult result;
+        m_parsingFollowUpRequest = &request;
+        {
+            TRACE_SCOPE("DownloadFinder::parseFollowUpResults");
+            result = parseFollowUpResults(request.download, request.buffer->data(), reasonForFail);
+        }
+        m_parsingFollowUpRequest = nullptr;
+        finishFollowUpRequest(request, result != ParsingResult::Error, reasonForFail);
+        break;
+    }
+    default:;
+    }
+}
+
+/*!
+ * \brief Frees the specified follow-up \a request, merges the results of the requests which are done in the order
+ *        the requests have been added and finishes the search if all requests are done.
+ * \remarks The specified \a request is invalidated.
+ */
+void DownloadFinder::finishFollowUpRequest(FollowUpRequest &request, bool success, const QString &reasonForFail)
+{
+    request.download->disconnect(this);
+    if (request.buffer) {
+        request.buffer->disconnect(this);
+    }
+    request.download->deleteLater();
+    request.done = true;
+    --m_runningFollowUpRequests;
+    if (success) {
+        m_followUpRequestSucceeded = true;
+    } else if (!reasonForFail.isEmpty()) {
+        m_followUpRequestFailure = reasonForFail;
+    }
+    while (!m_followUpRequests.empty() && m_followUpRequests.front().done) {
+        for (Download *const result : m_followUpRequests.front().results) {
+            const QUrl url = normalizedUrl(result->initialUrl());
+            if (m_heldBackResultsByInitialUrl.value(url) == result) {
+                m_heldBackResultsByInitialUrl.remove(url);
+            }
+            insertResult(result);
+        }
+        m_followUpRequests.pop_front();
+    }
+    startFollowUpRequests();
+    emitNewResultsSignal();
+    if (m_waitingForFollowUpRequests && m_followUpRequests.empty()) {
+        emitFollowUpRequestsFinishedSignal();
+    }
+}
+
+/*!
+ * \brief Finishes the search after all follow-up requests are done; it is considered successful if at least one
+ *        of them succeeded or results have been found anyways.
+ */
+void DownloadFinder::emitFollowUpRequestsFinishedSignal()
+{
+    const bool success = m_followUpRequestSucceeded || !m_results.isEmpty();
+    const QString reasonForFail = success ? QString() : m_followUpRequestFailure;
+    m_followUpRequestsAdded = m_waitingForFollowUpRequests = m_followUpRequestSucceeded = false;
+    m_followUpRequestFailure.clear();
+    emitFinishedSignal(success, reasonForFail);
+}
+
+/*!
+ * \brief Aborts all follow-up requests; results which have been kept back are discarded.
+ */
+void DownloadFinder::abortFollowUpRequests()
+{
+    for (FollowUpRequest &request : m_followUpRequests) {
+        if (!request.done) {
+            request.download->disconnect(this);
+            if (request.buffer) {
+                request.buffer->disconnect(this);
+            }
+            if (request.started) {
+                request.download->stop();
+            }
+            request.download->deleteLater();
+        }
+        qDeleteAll(request.results);
+    }
+    m_followUpRequests.clear();
+    m_heldBackResultsByInitialUrl.clear();
+    m_runningFollowUpRequests = 0;
+    m_followUpRequestsAdded = false;
+    m_waitingForFollowUpRequests = false;
+    m_followUpRequestSucceeded = false;
+    m_followUpRequestFailure.clear();
+}
+
+/*!
+ * \brief Adds the download URLs of the specified \a download to the index used by hasDownloadUrl().
+ */
+void DownloadFinder::indexDownloadUrls(Download *download)
+{
+    for (const OptionData &option : download->options()) {
+        if (!option.url().isEmpty()) {
+            m_downloadUrls.insert(normalizedUrl(option.url()));
+        }
+    }
+}
+
+/*!
+ * \brief Returns the form of the specified \a url used to detect duplicates.
+ *
+ * The fragment is removed and path segments like "." and ".." are resolved. The scheme and host are
+ * already lower case because QUrl normalizes them.
+ */
+QUrl DownloadFinder::normalizedUrl(const QUrl &url)
+{
+    return url.adjusted(QUrl::RemoveFragment | QUrl::NormalizePathSegments);
+}
+
 /*!
  * \brief Emits the new results signal.
  */
@@ -237,6 +540,7 @@ void DownloadFinder::emitNewResultsSignal()
  * \fn DownloadFinder::parseResults()
  * \brief Parses the results.
  *
- * Needs to be implemented when subclassing.
+ * Needs to be implemented when subclassing. If beginIncrementalParsing() returned true, the complete
+ * \a data has already been passed to parseChunk() so only the remaining work needs to be done.
  */
 } // namespace Network
@@ -2,9 +2,13 @@
 #define VIDEOFINDER_H
 
 #include <QBuffer>
+#include <QHash>
 #include <QNetworkProxy>
 #include <QObject>
+#include <QSet>
+#include <QUrl>
 
+#include <list>
 #include <memory>
 
 namespace Network {
@@ -26,12 +30,16 @@ public:
     void setProxy(const QNetworkProxy &proxy);
     bool hasFinished() const;
     bool isDownloading() const;
+    int maxConcurrentRequests() const;
+    void setMaxConcurrentRequests(int maxConcurrentRequests);
+    int maxFollowUpResponseSize() const;
+    void setMaxFollowUpResponseSize(int maxFollowUpResponseSize);
     Download *downloadByInitialUrl(const QUrl &url) const;
     bool hasDownloadUrl(const QUrl &url) const;
 
 public Q_SLOTS:
     bool start();
-    void stop();
+    virtual void stop();
     void setContinueAutomatically(bool continueAutomatically);
 
 Q_SIGNALS:
@@ -55,26 +63,64 @@ protected:
     virtual Download *createRequest(QString &reasonForFail) = 0;
     virtual bool finalizeRequest(Download *download, QString &reasonForFail);
     virtual ParsingResult parseResults(const QByteArray &data, QString &reasonForFail) = 0;
+    virtual bool beginIncrementalParsing();
+    virtual void parseChunk(const char *data, std::size_t size);
+    virtual ParsingResult parseFollowUpResults(Download *request, const QByteArray &data, QString &reasonForFail);
 
     void reportCollectionTitle(const QString &title);
     void reportResult(Download *result);
+    void addFollowUpRequest(Download *request);
 
 private Q_SLOTS:
     void downloadChangedStatus(Download *download);
     void downloadRequiresOutputDevice(Download *download, size_t option);
+    void parseAvailableData();
+    void indexDownloadUrls(Download *download);
 
 private:
+    /*!
+     * \brief The FollowUpRequest struct holds the state of a request added via addFollowUpRequest().
+     */
+    struct FollowUpRequest {
+        Download *download = nullptr;
+        QBuffer *buffer = nullptr;
+        QList<Download *> results;
+        bool started = false;
+        bool done = false;
+    };
+
     void emitNewResultsSignal();
     void emitFinishedSignal(bool success, const QString &reason = QString());
+    static QUrl normalizedUrl(const QUrl &url);
+    void insertResult(Download *result);
+    void startFollowUpRequests();
+    void followUpRequestChangedStatus(FollowUpRequest &request);
+    void finishFollowUpRequest(FollowUpRequest &request, bool success, const QString &reasonForFail);
+    void emitFollowUpRequestsFinishedSignal();
+    void abortFollowUpRequests();
 
     std::unique_ptr<Download> m_download;
     std::unique_ptr<QBuffer> m_buffer;
+    int m_parsedBytes;
+    bool m_parsingIncrementally;
     QString m_title;
     QNetworkProxy m_proxy;
     QList<Download *> m_results;
+    QHash<QUrl, Download *> m_resultsByInitialUrl;
+    QHash<QUrl, Download *> m_heldBackResultsByInitialUrl;
+    QSet<QUrl> m_downloadUrls;
     unsigned int m_resultCount;
     bool m_continueAutomatically;
     bool m_finished;
+    std::list<FollowUpRequest> m_followUpRequests;
+    FollowUpRequest *m_parsingFollowUpRequest;
+    int m_runningFollowUpRequests;
+    int m_maxConcurrentRequests;
+    int m_maxFollowUpResponseSize;
+    bool m_followUpRequestsAdded;
+    bool m_waitingForFollowUpRequests;
+    bool m_followUpRequestSucceeded;
+    QString m_followUpRequestFailure;
 };
 
 /*!
@@ -102,6 +148,8 @@ inline void DownloadFinder::clearResults()
 {
     emit aboutToClearResults();
     m_results.clear();
+    m_resultsByInitialUrl.clear();
+    m_downloadUrls.clear();
     m_resultCount = 0;
     emit resultsCleared();
 }
@@ -138,6 +186,42 @@ inline void DownloadFinder::setProxy(const QNetworkProxy &proxy)
     m_proxy = proxy;
 }
 
+/*!
+ * \brief Returns the max. number of follow-up requests (see addFollowUpRequest()) which run at the same time.
+ */
+inline int DownloadFinder::maxConcurrentRequests() const
+{
+    return m_maxConcurrentRequests;
+}
+
+/*!
+ * \brief Sets the max. number of follow-up requests (see addFollowUpRequest()) which run at the same time.
+ */
+inline void DownloadFinder::setMaxConcurrentRequests(int maxConcurrentRequests)
+{
+    m_maxConcurrentRequests = maxConcurrentRequests;
+}
+
+/*!
+ * \brief Returns the max. size of the response of a follow-up request (see addFollowUpRequest()) in bytes.
+ * \remarks The default is 0 which means the size is not limited.
+ */
+inline int DownloadFinder::maxFollowUpResponseSize() const
+{
+    return m_maxFollowUpResponseSize;
+}
+
+/*!
+ * \brief Sets the max. size of the response of a follow-up request (see addFollowUpRequest()) in bytes.
+ *
+ * Follow-up requests with a bigger response are aborted and considered failed. This prevents buffering
+ * huge responses which are not what the subclass expects anyways.
+ */
+inline void DownloadFinder::setMaxFollowUpResponseSize(int maxFollowUpResponseSize)
+{
+    m_maxFollowUpResponseSize = maxFollowUpResponseSize;
+}
+
 /*!
  * \brief Sets whether the search should continue automatically.
  */
@@ -162,6 +246,40 @@ inline bool DownloadFinder::finalizeRequest(Download *, QString &)
     return true;
 }
 
+/*!
+ * \brief Returns whether the response of the current request should be passed to parseChunk() while it is still downloading.
+ *
+ * Called when a new response is about to be received. The default implementation returns false so the
+ * response is only passed to parseResults() when complete.
+ */
+inline bool DownloadFinder::beginIncrementalParsing()
+{
+    return false;
+}
+
+/*!
+ * \brief Parses the next chunk of the current response.
+ *
+ * Only called if beginIncrementalParsing() returned true. Results reported via reportResult() are made
+ * available after each chunk. Chunks are arbitrary parts of the response, eg. a multi-byte character
+ * might be split.
+ */
+inline void DownloadFinder::parseChunk(const char *, std::size_t)
+{
+}
+
+/*!
+ * \brief Parses the response of the specified follow-up \a request (see addFollowUpRequest()).
+ *
+ * The default implementation calls parseResults(). Results reported via reportResult() are made available
+ * in the order the requests have been added, regardless of the order the responses arrive.
+ * \returns Returns ParsingResult::Error if the response could not be parsed; any other value indicates success.
+ */
+inline DownloadFinder::ParsingResult DownloadFinder::parseFollowUpResults(Download *, const QByteArray &data, QString &reasonForFail)
+{
+    return parseResults(data, reasonForFail);
+}
+
 /*!
  * \brief Reports the collection title.
  *
@@ -9,6 +9,8 @@
 #include <QJsonObject>
 #include <QJsonValue>
 
+#include <utility>
+
 using namespace CppUtilities;
 
 namespace Network {
@@ -31,6 +33,7 @@ GroovesharkSearcher::GroovesharkSearcher(const QString &searchTerm, GroovesharkS
     , m_searchType(searchTermRole)
     , m_currentId(0)
     , m_verified(verified)
+    , m_fetchingInParallel(false)
 {
     switch (searchTermRole) {
     case GroovesharkSearchTermRole::AlbumId:
@@ -57,10 +60,7 @@ Download *GroovesharkSearcher::createRequest(QString &reasonForFail)
             if (m_currentId >= m_ids.size()) {
                 reasonForFail = tr("Given id index is out of range.");
             } else {
-                GroovesharkGetSongsRequestData requestData;
-                requestData.id = m_ids.at(m_currentId);
-                requestData.verified = m_verified;
-                res = new GroovesharkDownload(GroovesharkRequestType::AlbumGetSongs, QVariant::fromValue(requestData));
+                res = createSongsRequest(m_ids.at(m_currentId));
             }
         } else if (!m_searchTerm.isEmpty()) {
             res = new GroovesharkDownload(GroovesharkRequestType::SearchForAlbum, QVariant::fromValue(m_searchTerm));
@@ -72,7 +72,7 @@ Download *GroovesharkSearcher::createRequest(QString &reasonForFail)
             if (m_currentId >= m_ids.size()) {
                 reasonForFail = tr("Given id index is out of range.");
             } else {
-                res = new GroovesharkDownload(GroovesharkRequestType::PlaylistGetSongs, QVariant::fromValue(m_ids.at(m_currentId)));
+                res = createSongsRequest(m_ids.at(m_currentId));
             }
         } else if (!m_searchTerm.isEmpty()) {
             res = new GroovesharkDownload(GroovesharkRequestType::SearchForPlaylist, QVariant::fromValue(m_searchTerm));
@@ -84,19 +84,52 @@ Download *GroovesharkSearcher::createRequest(QString &reasonForFail)
     return res;
 }
 
+/*!
+ * \brief Returns a request for the songs of the album or playlist with the specified \a id.
+ */
+Download *GroovesharkSearcher::createSongsRequest(const QString &id) const
+{
+    switch (m_searchType) {
+    case GroovesharkSearchTermRole::AlbumId:
+    case GroovesharkSearchTermRole::AlbumName: {
+        GroovesharkGetSongsRequestData requestData;
+        requestData.id = id;
+        requestData.verified = m_verified;
+        return new GroovesharkDownload(GroovesharkRequestType::AlbumGetSongs, QVariant::fromValue(requestData));
+    }
+    default:
+        return new GroovesharkDownload(GroovesharkRequestType::PlaylistGetSongs, QVariant::fromValue(id));
+    }
+}
+
+/*!
+ * \brief Returns the parsing result after the songs of the current collection have been parsed.
+ *
+ * If the songs of all collections are fetched in parallel, \a resultOfCurrentCollection is returned as-is.
+ * Otherwise the songs of the next collection are requested (if there is one) so the search can be continued
+ * step by step when it does not continue automatically.
+ */
+DownloadFinder::ParsingResult GroovesharkSearcher::continueWithNextCollection(ParsingResult resultOfCurrentCollection)
+{
+    if (m_fetchingInParallel) {
+        return resultOfCurrentCollection;
+    }
+    return (++m_currentId) < m_ids.size() ? ParsingResult::AnotherRequestRequired : resultOfCurrentCollection;
+}
+
 DownloadFinder::ParsingResult GroovesharkSearcher::parseResults(const QByteArray &data, QString &reasonForFail)
 {
     QJsonParseError error;
     QJsonDocument jsonDoc = QJsonDocument::fromJson(data, &error);
     if (!jsonDoc.isObject()) {
         reasonForFail = tr("The response of Grooveshark is no valid Json object (%1).").arg(error.errorString());
-        return (++m_currentId) < m_ids.size() ? ParsingResult::AnotherRequestRequired : ParsingResult::Error;
+        return continueWithNextCollection(ParsingResult::Error);
     }
     QJsonObject mainObj = jsonDoc.object();
     QJsonValue resVal = mainObj.value(QStringLiteral("result"));
     if (!resVal.isObject() && !resVal.isArray()) {
         reasonForFail = tr("No results found (no results array/object found).");
-        return (++m_currentId) < m_ids.size() ? ParsingResult::AnotherRequestRequired : ParsingResult::Error;
+        return continueWithNextCollection(ParsingResult::Error);
     }
     if (m_ids.isEmpty()) { // read albums/playlists
         if (resVal.isObject()) {
@@ -148,7 +181,16 @@ DownloadFinder::ParsingResult GroovesharkSearcher::parseResults(const QByteArray
         }
         m_currentId = 0;
         if (!m_ids.isEmpty()) {
-            return ParsingResult::AnotherRequestRequired;
+            if (!continuesAutomatically()) {
+                // fetch the songs of one collection after the other so the search can be continued step by step
+                return ParsingResult::AnotherRequestRequired;
+            }
+            // fetch the songs of all collections in parallel; the songs are ordered by collection nevertheless
+            m_fetchingInParallel = true;
+            for (const QString &id : std::as_const(m_ids)) {
+                addFollowUpRequest(createSongsRequest(id));
+            }
+            return ParsingResult::Success;
         }
         reasonForFail = tr("No collections found (relevant json array contains no parsable items).");
         return ParsingResult::Error;
@@ -166,16 +208,17 @@ DownloadFinder::ParsingResult GroovesharkSearcher::parseResults(const QByteArray
                 break;
             default:
                 reasonForFail = tr("The response can't be parsed because the given search type isn't supported.");
-                return (++m_currentId) < m_ids.size() ? ParsingResult::AnotherRequestRequired : ParsingResult::Error;
+                return continueWithNextCollection(ParsingResult::Error);
             }
         } else {
             songsVal = resVal;
         }
         if (!songsVal.isArray()) {
             reasonForFail = tr("No songs found (no songs object found).");
-            return (++m_currentId) < m_ids.size() ? ParsingResult::AnotherRequestRequired : ParsingResult::Error;
+            return continueWithNextCollection(ParsingResult::Error);
         }
         GroovesharkDownload *res = nullptr;
+        int songCount = 0;
         QJsonArray songsArray = songsVal.toArray();
         QJsonObject songObj;
         QJsonValue albumNameVal;
@@ -200,6 +243,7 @@ DownloadFinder::ParsingResult GroovesharkSearcher::parseResults(const QByteArray
                             durationVal.isString() ? TimeSpan::fromString(durationVal.toString().toStdString()) : TimeSpan(), albumNameVal.toString(),
                             trackNumVal.isString() ? trackNumVal.toString().toInt() : 0);
                         reportResult(res);
+                        ++songCount;
                     }
                     if ((collectionTitle().isEmpty() || collectionTitle().compare(tr("Unknown Album"), Qt::CaseInsensitive) == 0)
                         && albumNameVal.isString()) {
@@ -208,15 +252,13 @@ DownloadFinder::ParsingResult GroovesharkSearcher::parseResults(const QByteArray
                 }
             }
         }
-        if ((++m_currentId) < m_ids.size()) {
-            return ParsingResult::AnotherRequestRequired;
-        } else {
-            if (!results().isEmpty()) {
-                return ParsingResult::Success;
-            }
+        // when fetching step by step, the songs of the previous collections have already been added to the results
+        const auto result = continueWithNextCollection(
+            songCount || (!m_fetchingInParallel && !results().isEmpty()) ? ParsingResult::Success : ParsingResult::Error);
+        if (result == ParsingResult::Error) {
+            reasonForFail = tr("No songs found (relevant json array contains no parsable items).");
         }
-        reasonForFail = tr("No songs found (relevant json array contains no parsable items).");
-        return ParsingResult::Error;
+        return result;
     }
 }
 } // namespace Network
@@ -34,11 +34,15 @@ protected Q_SLOTS:
     ParsingResult parseResults(const QByteArray &data, QString &reasonForFail);
 
 private:
+    Download *createSongsRequest(const QString &id) const;
+    ParsingResult continueWithNextCollection(ParsingResult resultOfCurrentCollection);
+
     QString m_searchTerm;
     GroovesharkSearchTermRole m_searchType;
     QStringList m_ids;
     int m_currentId;
     bool m_verified;
+    bool m_fetchingInParallel;
 };
 
 /*!
@@ -4,16 +4,59 @@
 
 #include "../../application/utils.h"
 
-#include <QRegularExpression>
+#include <QStringList>
 
 using namespace CppUtilities;
 using namespace Application;
 
 namespace Network {
 
+/*!
+ * \brief Specifies the max. size of a page fetched when crawling; bigger responses are unlikely index pages.
+ */
+constexpr int maxPageSize = 16 * 1024 * 1024;
+
+/*!
+ * \brief Returns whether the specified \a url likely refers to another HTML page (rather than to a file to be downloaded).
+ *
+ * Directories (as found in directory-style listings) and files with a typical extension of HTML pages are considered.
+ */
+static bool isPageUrl(const QUrl &url)
+{
+    const QString fileName = url.fileName();
+    if (fileName.isEmpty()) {
+        return true;
+    }
+    const auto dotIndex = fileName.lastIndexOf(QLatin1Char('.'));
+    if (dotIndex < 0) {
+        return false;
+    }
+    static const QStringList pageSuffixes{ QStringLiteral("htm"), QStringLiteral("html"), QStringLiteral("xhtml"), QStringLiteral("php"),
+        QStringLiteral("asp"), QStringLiteral("aspx"), QStringLiteral("jsp"), QStringLiteral("cgi") };
+    return pageSuffixes.contains(fileName.mid(dotIndex + 1), Qt::CaseInsensitive);
+}
+
+/*!
+ * \brief Returns the form of the specified page \a url used to detect pages which have already been visited.
+ *
+ * The query of directories is removed as well because directory-style listings (eg. Apache's autoindex) link
+ * to the same listing in a different order via the query (eg. "?C=N;O=D").
+ */
+static QUrl normalizedPageUrl(const QUrl &url)
+{
+    const auto isDirectory = url.fileName().isEmpty();
+    return url.adjusted(QUrl::RemoveFragment | QUrl::NormalizePathSegments | (isDirectory ? QUrl::RemoveQuery : QUrl::None));
+}
+
 /*!
  * \class LinkFinder
  * \brief The LinkFinder class retrieves links from an ordinary webpage.
+ *
+ * By default, only the specified page is scanned. When a crawl depth is set, links to further pages within
+ * the crawl scope are followed instead of being reported as results. This allows adding downloads from
+ * directory-style listings spread over many subpages. Each page is fetched only once and the number of pages
+ * fetched in total is limited. The pages are fetched as follow-up requests so at most maxConcurrentRequests()
+ * pages are fetched at the same time and their results are ordered as if they were fetched one after another.
  */
 
 /*!
@@ -22,73 +65,140 @@ namespace Network {
 LinkFinder::LinkFinder(const QUrl &url, QObject *parent)
     : DownloadFinder(parent)
     , m_url(url)
+    , m_crawlDepth(0)
+    , m_crawlScope(CrawlScope::SameHost)
+    , m_maxPages(1000)
 {
+    setMaxFollowUpResponseSize(maxPageSize);
+    // the position is only known when the results are made available because results of further pages are kept back
+    // until the previously added pages are done; connected first so it is set before others receive the results
+    connect(this, &DownloadFinder::newResultsAvailable, this, [this](const QList<Download *> &newResults) {
+        auto position = static_cast<int>(results().size() - newResults.size());
+        for (Download *const result : newResults) {
+            result->provideMetaData(QString(), QString(), TimeSpan(), QString(), position++);
+        }
+    });
 }
 
 Download *LinkFinder::createRequest(QString &)
 {
+    m_visitedPages.clear();
+    m_pageDepths.clear();
+    m_visitedPages.insert(normalizedPageUrl(m_url));
+    m_crawlPrefix = m_url.adjusted(QUrl::RemoveFilename | QUrl::RemoveQuery | QUrl::RemoveFragment).toString();
     return new HttpDownload(m_url, this);
 }
 
-DownloadFinder::ParsingResult LinkFinder::parseResults(const QByteArray &data, QString &)
+DownloadFinder::ParsingResult LinkFinder::parseResults(const QByteArray &, QString &)
+{
+    m_tokenizer.finish();
+    processLinks(m_tokenizer, m_url, 0, m_pageTitle);
+    // the search is finished when all further pages have been fetched as well
+    return DownloadFinder::ParsingResult::Success;
+}
+
+/*!
+ * \brief Prepares the tokenizer for the new page; the page is always parsed while it is still downloading.
+ */
+bool LinkFinder::beginIncrementalParsing()
+{
+    m_tokenizer.reset();
+    m_pageTitle.clear();
+    return true;
+}
+
+void LinkFinder::parseChunk(const char *data, std::size_t size)
+{
+    m_tokenizer.feed(data, size);
+    processLinks(m_tokenizer, m_url, 0, m_pageTitle);
+}
+
+/*!
+ * \brief Parses a further page which has been fetched when crawling.
+ * \remarks Pages which can not be fetched are skipped; the search is still considered successful if links have
+ *          been found on other pages.
+ */
+DownloadFinder::ParsingResult LinkFinder::parseFollowUpResults(Download *request, const QByteArray &data, QString &)
 {
-    QString html(data);
-    static const QRegularExpression titlePattern(
-        QStringLiteral("<title>(.+)</title>"), QRegularExpression::CaseInsensitiveOption | QRegularExpression::InvertedGreedinessOption);
-    static const QRegularExpression linkPattern(
-        QStringLiteral("<a([^>]+)>(.+)</a>"), QRegularExpression::CaseInsensitiveOption | QRegularExpression::InvertedGreedinessOption);
-    static const QRegularExpression commentPattern(
-        QStringLiteral("<!--(.+)-->"), QRegularExpression::CaseInsensitiveOption | QRegularExpression::InvertedGreedinessOption);
-    static const QRegularExpression hrefPattern1(
-        QStringLiteral("\\s*href\\s*=\\s*['](.+)['>]"), QRegularExpression::CaseInsensitiveOption | QRegularExpression::InvertedGreedinessOption);
-    static const QRegularExpression hrefPattern2(
-        QStringLiteral("\\s*href\\s*=\\s*[\"](.+)[\">]"), QRegularExpression::CaseInsensitiveOption | QRegularExpression::InvertedGreedinessOption);
+    HtmlTokenizer tokenizer;
     QString pageTitle;
-    const auto titleMatch = titlePattern.match(html);
-    if (titleMatch.hasMatch()) {
-        pageTitle = titleMatch.captured(1);
+    tokenizer.feed(data);
+    tokenizer.finish();
+    processLinks(tokenizer, request->initialUrl(), m_pageDepths.take(request), pageTitle);
+    return DownloadFinder::ParsingResult::Success;
+}
+
+/*!
+ * \brief Reports the links the specified \a tokenizer has found so far on the page with the specified \a pageUrl.
+ *
+ * When crawling, links to further pages are enqueued (if the \a depth of the page allows it) instead.
+ */
+void LinkFinder::processLinks(HtmlTokenizer &tokenizer, const QUrl &pageUrl, int depth, QString &pageTitle)
+{
+    if (pageTitle.isEmpty() && tokenizer.hasTitle()) {
+        pageTitle = tokenizer.title();
         replaceHtmlEntities(pageTitle);
     }
-    auto commentMatch = commentPattern.match(html, 0);
-    decltype(commentMatch.capturedEnd()) overallIndex = 0;
-    for (auto linkMatch = linkPattern.match(html, overallIndex); linkMatch.hasMatch(); linkMatch = linkPattern.match(html, overallIndex)) {
-        if (commentMatch.capturedStart() >= 0 && commentMatch.capturedStart() < linkMatch.capturedStart()) {
-            // skip comment
-            overallIndex = commentMatch.capturedEnd();
-            commentMatch = commentPattern.match(html, overallIndex);
-            break;
+    for (HtmlTokenizer::Link &link : tokenizer.takeLinks()) {
+        QString &title = link.text, &urlStr = link.href;
+        replaceHtmlEntities(title);
+        replaceHtmlEntities(urlStr);
+        if (urlStr.isEmpty()) {
+            continue;
         }
-        // read actual link
-        QString title = linkMatch.captured(2), href = linkMatch.captured(1), urlStr;
-        const auto hrefMatch1 = hrefPattern1.match(href);
-        if (hrefMatch1.hasMatch()) {
-            urlStr = hrefMatch1.captured(1);
-        } else {
-            const auto hrefMatch2 = hrefPattern2.match(href);
-            if (hrefMatch2.hasMatch()) {
-                urlStr = hrefMatch2.captured(1);
-            }
+        // resolve relative URLs
+        QUrl url(urlStr);
+        if (url.isRelative()) {
+            url = pageUrl.resolved(url);
         }
-        if (!urlStr.isEmpty()) {
-            replaceHtmlEntities(title);
-            replaceHtmlEntities(urlStr);
-            // resolve relative URLs
-            QUrl url(urlStr);
-            if (url.isRelative()) {
-                url = m_url.resolved(url);
+        // follow links to further pages when crawling instead of reporting them
+        if (m_crawlDepth > 0 && isPageUrl(url) && isInCrawlScope(url)) {
+            if (depth < m_crawlDepth) {
+                enqueuePage(url, depth + 1);
             }
-            // avoid duplicate results
-            if (Download *const duplicateDownload = downloadByInitialUrl(url)) {
-                if (!title.isEmpty() && duplicateDownload->title().isEmpty()) {
-                    duplicateDownload->provideMetaData(title);
-                }
-            } else if (Download *result = Download::fromUrl(url)) {
-                result->provideMetaData(title, QString(), TimeSpan(), pageTitle, results().size());
-                reportResult(result);
+            continue;
+        }
+        // avoid duplicate results
+        if (Download *const duplicateDownload = downloadByInitialUrl(url)) {
+            if (!title.isEmpty() && duplicateDownload->title().isEmpty()) {
+                duplicateDownload->provideMetaData(title);
             }
+        } else if (Download *result = Download::fromUrl(url)) {
+            result->provideMetaData(title, QString(), TimeSpan(), pageTitle);
+            reportResult(result);
         }
-        overallIndex = linkMatch.capturedEnd();
     }
-    return DownloadFinder::ParsingResult::Success;
+}
+
+/*!
+ * \brief Returns whether links to the page with the specified \a url are followed when crawling.
+ */
+bool LinkFinder::isInCrawlScope(const QUrl &url) const
+{
+    if (url.scheme() != QLatin1String("http") && url.scheme() != QLatin1String("https")) {
+        return false;
+    }
+    switch (m_crawlScope) {
+    case CrawlScope::SameHost:
+        return url.host() == m_url.host();
+    case CrawlScope::Prefix:
+        return url.adjusted(QUrl::RemoveQuery | QUrl::RemoveFragment).toString().startsWith(m_crawlPrefix);
+    }
+    return false;
+}
+
+/*!
+ * \brief Enqueues the page with the specified \a url unless it has already been visited or the max. number of pages has been reached.
+ */
+void LinkFinder::enqueuePage(const QUrl &url, int depth)
+{
+    const QUrl pageUrl = normalizedPageUrl(url);
+    if (m_visitedPages.size() >= m_maxPages || m_visitedPages.contains(pageUrl)) {
+        return;
+    }
+    m_visitedPages.insert(pageUrl);
+    auto *const page = new HttpDownload(pageUrl);
+    m_pageDepths.insert(page, depth);
+    addFollowUpRequest(page);
 }
 } // namespace Network
@@ -3,24 +3,110 @@
 
 #include "./downloadfinder.h"
 
+#include "../misc/htmltokenizer.h"
+
+#include <QHash>
+#include <QSet>
 #include <QUrl>
 
 namespace Network {
 
+/*!
+ * \brief Specifies which links the LinkFinder follows when crawling.
+ */
+enum class CrawlScope {
+    SameHost, /**< Links to pages on the host of the initial page are followed. */
+    Prefix /**< Only links to pages within the directory of the initial page (or its subdirectories) are followed. */
+};
+
 class LinkFinder : public DownloadFinder {
     Q_OBJECT
 public:
     explicit LinkFinder(const QUrl &url, QObject *parent = nullptr);
 
+    int crawlDepth() const;
+    void setCrawlDepth(int crawlDepth);
+    CrawlScope crawlScope() const;
+    void setCrawlScope(CrawlScope crawlScope);
+    int maxPages() const;
+    void setMaxPages(int maxPages);
+
 protected:
     Download *createRequest(QString &);
 
 protected Q_SLOTS:
-    ParsingResult parseResults(const QByteArray &data, QString &);
+    ParsingResult parseResults(const QByteArray &, QString &);
+    bool beginIncrementalParsing();
+    void parseChunk(const char *data, std::size_t size);
+    ParsingResult parseFollowUpResults(Download *request, const QByteArray &data, QString &);
 
 private:
+    void processLinks(HtmlTokenizer &tokenizer, const QUrl &pageUrl, int depth, QString &pageTitle);
+    bool isInCrawlScope(const QUrl &url) const;
+    void enqueuePage(const QUrl &url, int depth);
+
     QUrl m_url;
+    HtmlTokenizer m_tokenizer;
+    QString m_pageTitle;
+    int m_crawlDepth;
+    CrawlScope m_crawlScope;
+    int m_maxPages;
+    QString m_crawlPrefix;
+    QSet<QUrl> m_visitedPages;
+    QHash<const Download *, int> m_pageDepths;
 };
+
+/*!
+ * \brief Returns how many levels of links to further pages are followed.
+ * \remarks The default is 0 which means only the specified page is scanned.
+ */
+inline int LinkFinder::crawlDepth() const
+{
+    return m_crawlDepth;
+}
+
+/*!
+ * \brief Sets how many levels of links to further pages are followed.
+ * \remarks Must be set before starting the search.
+ */
+inline void LinkFinder::setCrawlDepth(int crawlDepth)
+{
+    m_crawlDepth = crawlDepth;
+}
+
+/*!
+ * \brief Returns which links are followed when crawling.
+ */
+inline CrawlScope LinkFinder::crawlScope() const
+{
+    return m_crawlScope;
+}
+
+/*!
+ * \brief Sets which links are followed when crawling.
+ * \remarks Must be set before starting the search.
+ */
+inline void LinkFinder::setCrawlScope(CrawlScope crawlScope)
+{
+    m_crawlScope = crawlScope;
+}
+
+/*!
+ * \brief Returns the max. number of pages (including the specified page) fetched when crawling.
+ */
+inline int LinkFinder::maxPages() const
+{
+    return m_maxPages;
+}
+
+/*!
+ * \brief Sets the max. number of pages (including the specified page) fetched when crawling.
+ * \remarks Must be set before starting the search.
+ */
+inline void LinkFinder::setMaxPages(int maxPages)
+{
+    m_maxPages = maxPages;
+}
 } // namespace Network
 
 #endif // LINKFINDER_H
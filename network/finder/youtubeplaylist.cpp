@@ -3,6 +3,8 @@
 #include "../httpdownload.h"
 #include "../youtubedownload.h"
 
+#include "../misc/textscanner.h"
+
 #include "../../application/utils.h"
 
 #include <QUrlQuery>
@@ -49,62 +51,72 @@ Download *YoutubePlaylist::createRequest(QString &reasonForFail)
 
 YoutubePlaylist::ParsingResult YoutubePlaylist::parseResults(const QByteArray &data, QString &reasonForFail)
 {
-    QString playlistInfo(data);
+    static const QStringMatcher quoteMarker(QStringLiteral("\""));
+    static const QStringMatcher collectionTitleMarker(QStringLiteral("\"title\" content=\""));
+    static const QStringMatcher videoLinkMarker(QStringLiteral("<a class=\"pl-video-title-link"), Qt::CaseInsensitive);
+    static const QStringMatcher idMarker(QStringLiteral("href=\"/watch?v="), Qt::CaseInsensitive);
+    static const QStringMatcher idEndMarker(QStringLiteral("&amp;list="), Qt::CaseInsensitive);
+    static const QStringMatcher indexMarker(QStringLiteral("&amp;index="), Qt::CaseInsensitive);
+    static const QStringMatcher titleMarker(QStringLiteral("title=\""));
+    static const QStringMatcher videoOwnerMarker(QStringLiteral("<span class=\"video-owner\">"));
+    static const QStringMatcher uploaderMarker(QStringLiteral(" dir=\"ltr\">"));
+    static const QStringMatcher uploaderEndMarker(QStringLiteral("</a>"));
+    static const QStringMatcher durationMarker(QStringLiteral("<span class=\"video-time\">"));
+    static const QStringMatcher durationEndMarker(QStringLiteral("</span>"));
+
+    // scan the page in one pass; the values of each video are extracted in the order they appear
+    const QString playlistInfo(data);
+    TextScanner scanner(playlistInfo);
     QString collectionTitle;
-    if (substring(playlistInfo, collectionTitle, 0, QStringLiteral("\"title\" content=\""), QStringLiteral("\"")) > 0) {
+    if (scanner.extract(collectionTitleMarker, quoteMarker, collectionTitle)) {
         replaceHtmlEntities(collectionTitle);
     }
     reportCollectionTitle(collectionTitle);
     YoutubeDownload *res = nullptr;
-    int indexIndex = 0;
-    int hrefIndex = 0;
-    int nextAmpIndex = 0;
-    int videoOwnerIndex = 0;
     QString id, title, uploader, durationStr;
-    for (int index = 1;; ++index) {
+    for (int index = 1; scanner.skipPast(videoLinkMarker); ++index) {
         id.clear();
         title.clear();
         uploader.clear();
         durationStr.clear();
-        indexIndex = playlistInfo.indexOf(QLatin1String("<a class=\"pl-video-title-link"), indexIndex, Qt::CaseInsensitive);
-        if (indexIndex > -1) {
-            indexIndex = playlistInfo.indexOf(QLatin1String("&amp;index="), indexIndex, Qt::CaseInsensitive);
-            if (indexIndex > -1) {
-                hrefIndex = playlistInfo.lastIndexOf(QLatin1String("href=\"/watch?v="), indexIndex, Qt::CaseInsensitive);
-                if (hrefIndex > -1) {
-                    hrefIndex += 15;
-                    // get video id
-                    nextAmpIndex = playlistInfo.indexOf(QLatin1String("&amp;list="), hrefIndex, Qt::CaseInsensitive);
-                    if (nextAmpIndex > hrefIndex) {
-                        id = playlistInfo.mid(hrefIndex, nextAmpIndex - hrefIndex);
-                    } else {
-                        continue;
-                    }
-                    // get title
-                    if (substring(playlistInfo, title, indexIndex, QStringLiteral("title=\""), QStringLiteral("\"")) > indexIndex) {
-                        replaceHtmlEntities(title);
-                    } else {
-                        continue;
-                    }
-                    // get uploader
-                    videoOwnerIndex = playlistInfo.indexOf(QLatin1String("<span class=\"video-owner\">"), indexIndex);
-                    substring(playlistInfo, uploader, videoOwnerIndex, QStringLiteral(" dir=\"ltr\">"), QStringLiteral("</a>"));
-                    // get duration
-                    substring(playlistInfo, durationStr, videoOwnerIndex, QStringLiteral("<span class=\"video-time\">"), QStringLiteral("</span>"));
-                    // construct download, provide obtained meta data, and report it as result
-                    res = new YoutubeDownload(id);
-                    res->provideMetaData(title, uploader, durationStr.isEmpty() ? TimeSpan() : TimeSpan::fromString(durationStr.toStdString()),
-                        collectionTitle, index);
-                    reportResult(res);
-                } else {
-                    continue;
-                }
-            } else {
-                break;
-            }
-        } else {
+        // get video id
+        if (!scanner.skipPast(idMarker) || !scanner.readUntil(idEndMarker, id) || id.isEmpty()) {
+            continue;
+        }
+        if (!scanner.skipPast(indexMarker)) {
             break;
         }
+        // get title
+        if (scanner.extract(titleMarker, quoteMarker, title)) {
+            replaceHtmlEntities(title);
+        } else {
+            continue;
+        }
+        // get uploader and duration; only accept matches before the next video link because deleted or private
+        // videos have no owner span and the values of the next video must not be consumed
+        const auto entryEnd = [&scanner, &playlistInfo] {
+            const auto nextVideoLink = scanner.find(videoLinkMarker);
+            return nextVideoLink < 0 ? static_cast<int>(playlistInfo.size()) : nextVideoLink;
+        }();
+        const auto extractWithinEntry = [&scanner, entryEnd](const QStringMatcher &startMarker, const QStringMatcher &endMarker, QString &target) {
+            const auto position = scanner.position();
+            if (scanner.extract(startMarker, endMarker, target) && scanner.position() <= entryEnd) {
+                return;
+            }
+            scanner.setPosition(position);
+            target.clear();
+        };
+        const auto videoOwner = scanner.find(videoOwnerMarker);
+        if (videoOwner >= 0 && videoOwner < entryEnd) {
+            scanner.setPosition(videoOwner);
+            extractWithinEntry(uploaderMarker, uploaderEndMarker, uploader);
+            extractWithinEntry(durationMarker, durationEndMarker, durationStr);
+        }
+        // construct download, provide obtained meta data, and report it as result
+        res = new YoutubeDownload(id);
+        res->provideMetaData(
+            title, uploader, durationStr.isEmpty() ? TimeSpan() : TimeSpan::fromString(durationStr.toStdString()), collectionTitle, index);
+        reportResult(res);
     }
     if (res) {
         return ParsingResult::Success;
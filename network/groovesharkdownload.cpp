@@ -1,5 +1,7 @@
 #include "./groovesharkdownload.h"
 
+#include "./misc/textscanner.h"
+
 #include "../application/utils.h"
 
 #include "resources/config.h"
@@ -176,10 +178,19 @@ void GroovesharkDownload::resetSession()
 
 void GroovesharkDownload::evalVideoInformation(Download *, QBuffer *videoInfoBuffer)
 {
+    static const QStringMatcher quoteMarker(QStringLiteral("\""));
+    static const QStringMatcher sessionMarker(QStringLiteral("\"session\":\""));
+    static const QStringMatcher messageMarker(QStringLiteral("\"message\":\""));
+    static const QStringMatcher resultMarker(QStringLiteral("\"result\":\""));
+    static const QStringMatcher streamKeyMarker(QStringLiteral("\"streamKey\":\""));
+    static const QStringMatcher streamHostMarker(QStringLiteral("\"ip\":\""));
+
     QString code;
     if (videoInfoBuffer) { // the buffer might be zero!
         code.append(videoInfoBuffer->readAll());
     }
+    // the order of the members in the responses is not defined, so each value is searched in the whole response
+    TextScanner scanner(code);
     switch (m_currentStep) {
     case -1:
         setupFinalRequest();
@@ -187,8 +198,9 @@ void GroovesharkDownload::evalVideoInformation(Download *, QBuffer *videoInfoBuf
         break;
     case 0: {
         QString value;
-        if ((substring(code, value, 0, QStringLiteral("\"session\":\""), QStringLiteral("\"")) <= 0) || value.isEmpty()) {
-            if ((substring(code, value, 0, QStringLiteral("\"message\":\""), QStringLiteral("\"")) <= 0) || value.isEmpty()) {
+        if (!scanner.extract(sessionMarker, quoteMarker, value) || value.isEmpty()) {
+            scanner.setPosition(0);
+            if (!scanner.extract(messageMarker, quoteMarker, value) || value.isEmpty()) {
                 reportInitiated(false, tr("The session couldn't be initialized."));
             } else {
                 reportInitiated(false, tr("The session couldn't be initialized (%1).").arg(value));
@@ -201,7 +213,7 @@ void GroovesharkDownload::evalVideoInformation(Download *, QBuffer *videoInfoBuf
         break;
     }
     case 1:
-        if ((substring(code, m_token, 0, QStringLiteral("\"result\":\""), QStringLiteral("\"")) <= 0) || m_token.isEmpty()) {
+        if (!scanner.extract(resultMarker, quoteMarker, m_token) || m_token.isEmpty()) {
             reportInitiated(false, tr("The communication token couldn't be retireved."));
         } else {
             if (m_requestType == GroovesharkRequestType::SongStream) {
@@ -214,10 +226,11 @@ void GroovesharkDownload::evalVideoInformation(Download *, QBuffer *videoInfoBuf
         }
         break;
     case 2:
-        if ((substring(code, m_streamKey, 0, QStringLiteral("\"streamKey\":\""), QStringLiteral("\"")) <= 0) || m_streamKey.isEmpty()) {
+        if (!scanner.extract(streamKeyMarker, quoteMarker, m_streamKey) || m_streamKey.isEmpty()) {
             reportInitiated(false, tr("The stream key couldn't be found."));
         } else {
-            if ((substring(code, m_streamHost, 0, QStringLiteral("\"ip\":\""), QStringLiteral("\"")) <= 0) || m_streamHost.isEmpty()) {
+            scanner.setPosition(0);
+            if (!scanner.extract(streamHostMarker, quoteMarker, m_streamHost) || m_streamHost.isEmpty()) {
                 reportInitiated(false, tr("The stream host couldn't be found."));
             } else {
                 setupFinalRequest();
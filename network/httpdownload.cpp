@@ -1,14 +1,40 @@
 #include "./httpdownload.h"
 
 #include "./misc/contentdispositionparser.h"
+#include "./misc/http2policy.h"
+#include "./misc/proxypool.h"
+#include "./misc/sslsessioncache.h"
 
+#include "../application/tracing.h"
+
+#include <QDateTime>
 #include <QFileInfo>
+#ifndef QT_NO_OPENSSL
+#include <QSslConfiguration>
+#endif
+
+#include <utility>
 
 using namespace std;
 
 namespace Network {
 
 QNetworkAccessManager *HttpDownload::m_mgr = nullptr;
+int HttpDownload::m_activeReplies = 0;
+quint64 HttpDownload::m_totalRetries = 0;
+
+/*!
+ * \brief Specifies limits for the read buffer size of replies.
+ * \sa HttpDownload::adjustReadBufferSize()
+ */
+namespace ReadBufferLimits {
+constexpr qint64 min = 16 * 1024;
+constexpr qint64 initial = 256 * 1024;
+constexpr qint64 max = 8 * 1024 * 1024;
+constexpr qint64 totalBudget = 64 * 1024 * 1024;
+constexpr qint64 minRoundTripTime = 10;
+constexpr qint64 updateInterval = 500;
+} // namespace ReadBufferLimits
 
 /*!
  * \class HttpDownloadInfo
@@ -30,6 +56,7 @@ HttpDownload::HttpDownload(const QUrl &url, QObject *parent)
     //m_replies(nullptr),
     m_method(HttpDownloadMethod::Get)
     , m_redirectionIndex(-1)
+    , m_triedProxiesGeneration(0)
 {
     if (!m_mgr) {
         m_mgr = new QNetworkAccessManager();
@@ -43,6 +70,13 @@ HttpDownload::HttpDownload(const QUrl &url, QObject *parent)
 
 HttpDownload::~HttpDownload()
 {
+    for (QNetworkReply *reply : m_replies) {
+        releaseProxy(reply);
+    }
+    // release the proxies of pending probes (see doProbeExpectedSize()) as well
+    for (QNetworkReply *reply : findChildren<QNetworkReply *>(QString(), Qt::FindDirectChildrenOnly)) {
+        releaseProxy(reply);
+    }
     qDeleteAll(m_replies);
 }
 
@@ -64,9 +98,32 @@ void HttpDownload::doInit()
  */
 void HttpDownload::startRequest(size_t optionIndex)
 {
-    // apply current configuration
-    m_mgr->setProxy(proxy());
+    // apply current configuration; use the least-loaded proxy of the pool if there are any, preferring the ones
+    // which have not been tried yet for the current option
+    auto &proxyPool = ProxyPool::instance();
+    if (m_triedProxiesGeneration != proxyPool.generation()) {
+        m_triedProxies.clear();
+        m_triedProxiesGeneration = proxyPool.generation();
+    }
+    const auto proxyIndex = proxyPool.acquire(m_triedProxies);
+    if (proxyIndex >= 0 && !m_triedProxies.contains(proxyIndex)) {
+        m_triedProxies << proxyIndex;
+    }
+    m_mgr->setProxy(proxyIndex >= 0 ? proxyPool.proxy(proxyIndex) : proxy());
     m_request.setUrl(downloadUrl(optionIndex));
+    // set explicitly because the default differs between Qt versions
+    m_request.setAttribute(QNetworkRequest::Http2AllowedAttribute, Http2Policy::instance().isAllowed(m_request.url()));
+#ifndef QT_NO_OPENSSL
+    // resume the TLS session from a previous connection to the same host if possible
+    const auto sessionKey = SslSessionCache::keyForUrl(m_request.url());
+    if (!sessionKey.isEmpty()) {
+        // keep SSL settings made for the request (defaults to QSslConfiguration::defaultConfiguration())
+        auto sslConfig = m_request.sslConfiguration();
+        sslConfig.setSslOption(QSsl::SslOptionDisableSessionPersistence, false);
+        sslConfig.setSessionTicket(SslSessionCache::instance().sessionTicket(sessionKey));
+        m_request.setSslConfiguration(sslConfig);
+    }
+#endif
     if (!userAgent().isEmpty()) {
         m_request.setHeader(QNetworkRequest::UserAgentHeader, userAgent().toLocal8Bit());
     }
@@ -106,9 +163,93 @@ void HttpDownload::startRequest(size_t optionIndex)
     m_replies << reply;
     reply->setProperty("optionindex", QVariant::fromValue(optionIndex));
     reply->setProperty("headerread", false);
+    // start with a moderate read buffer; it is adjusted once the throughput is known
+    ++m_activeReplies;
+    connect(reply, &QObject::destroyed, [] { --m_activeReplies; });
+    const auto readBufferSize = qBound(ReadBufferLimits::min, ReadBufferLimits::totalBudget / m_activeReplies, ReadBufferLimits::initial);
+    reply->setReadBufferSize(readBufferSize);
+    reply->setProperty("requesttime", QDateTime::currentMSecsSinceEpoch());
+    reply->setProperty("proxyindex", proxyIndex);
+    reply->setProperty("proxygeneration", proxyPool.generation());
+    reportReadBufferSize(optionIndex, readBufferSize);
+    reportTransferPhase(optionIndex, TransferTimings::Phase::RequestIssued);
     connect(reply, &QNetworkReply::downloadProgress, this, &HttpDownload::slotDownloadProgress);
     connect(reply, &QNetworkReply::readyRead, this, &HttpDownload::slotReadyRead);
     connect(reply, &QNetworkReply::finished, this, &HttpDownload::slotFinished);
+#if QT_VERSION >= QT_VERSION_CHECK(6, 3, 0)
+    connect(reply, &QNetworkReply::socketStartedConnecting, this, &HttpDownload::slotSocketStartedConnecting);
+    connect(reply, &QNetworkReply::requestSent, this, &HttpDownload::slotRequestSent);
+#endif
+#ifndef QT_NO_OPENSSL
+    if (!sessionKey.isEmpty()) {
+        reply->setProperty("sslsessionkey", sessionKey);
+    }
+    connect(reply, &QNetworkReply::encrypted, this, &HttpDownload::slotEncrypted);
+#endif
+}
+
+/*!
+ * \brief Adjusts the read buffer size of the specified \a reply.
+ *
+ * The size is computed as twice the bandwidth-delay product of the reply. The throughput is measured since the
+ * first byte has been received and the delay is approximated by the time it took to receive the first byte. So
+ * fast links get large buffers to receive the data in large chunks and slow links get small buffers.
+ *
+ * The size is limited to the share of the total budget of the reply so memory usage is bounded when many
+ * downloads run in parallel. If the downloaded data can not be written to the output device yet and needs to be
+ * buffered anyway the minimum size is used.
+ */
+void HttpDownload::adjustReadBufferSize(QNetworkReply *reply, size_t optionIndex, qint64 bytesReceived)
+{
+    const auto firstByteTime = reply->property("firstbytetime").toLongLong();
+    if (!firstByteTime) {
+        return;
+    }
+    const auto now = QDateTime::currentMSecsSinceEpoch();
+    if (now - reply->property("readbuffertime").toLongLong() < ReadBufferLimits::updateInterval) {
+        return;
+    }
+    reply->setProperty("readbuffertime", now);
+    const auto elapsed = now - firstByteTime;
+    if (elapsed <= 0) {
+        return;
+    }
+    qint64 readBufferSize;
+    if (options().at(optionIndex).isBuffering()) {
+        readBufferSize = ReadBufferLimits::min;
+    } else {
+        const auto roundTripTime = qMax(firstByteTime - reply->property("requesttime").toLongLong(), ReadBufferLimits::minRoundTripTime);
+        const auto bandwidthDelayProduct = bytesReceived * roundTripTime / elapsed;
+        const auto share = ReadBufferLimits::totalBudget / qMax(m_activeReplies, 1);
+        readBufferSize = qBound(ReadBufferLimits::min, bandwidthDelayProduct * 2, qBound(ReadBufferLimits::min, share, ReadBufferLimits::max));
+    }
+    if (readBufferSize != reply->readBufferSize()) {
+        reply->setReadBufferSize(readBufferSize);
+        reportReadBufferSize(optionIndex, readBufferSize);
+    }
+}
+
+/*!
+ * \brief Hands the proxy used by the specified \a reply back to the ProxyPool.
+ * \remarks Does nothing if the reply has not been made via the pool or if the proxy has already been released.
+ */
+void HttpDownload::releaseProxy(QNetworkReply *reply)
+{
+    bool ok;
+    const auto proxyIndex = reply->property("proxyindex").toInt(&ok);
+    if (!ok || proxyIndex < 0 || reply->property("proxyreleased").toBool()) {
+        return;
+    }
+    auto &proxyPool = ProxyPool::instance();
+    const auto proxyGeneration = reply->property("proxygeneration").toUInt();
+    proxyPool.release(proxyIndex, proxyGeneration, reply->property("bytesreceived").toLongLong(),
+        QDateTime::currentMSecsSinceEpoch() - reply->property("requesttime").toLongLong());
+    if (ProxyPool::isProxyError(reply->error())) {
+        proxyPool.reportFailure(proxyIndex, proxyGeneration);
+    } else {
+        proxyPool.reportSuccess(proxyIndex, proxyGeneration);
+    }
+    reply->setProperty("proxyreleased", true);
 }
 
 /*!
@@ -125,60 +266,75 @@ QString HttpDownload::readTitleFromUrl(const QUrl &url)
 
 void HttpDownload::checkStatusAndClear(size_t optionIndex)
 {
+    // find the reply first because handling it modifies m_replies (eg. when retrying via another proxy)
+    QNetworkReply *reply = nullptr;
     bool ok;
-    for (QNetworkReply *reply : m_replies) {
-        if (reply->property("optionindex").toUInt(&ok) == optionIndex && ok) {
-            QString reasonForFail;
-            QNetworkReply::NetworkError error = reply->error();
-            if (error != QNetworkReply::NoError) {
-                reasonForFail = reply->errorString();
-                if ((error == QNetworkReply::OperationCanceledError) && (status() == DownloadStatus::Interrupting)) {
-                    // download has been interrupted by the user
-                    reportDownloadInterrupted(optionIndex);
-                    reply->deleteLater();
-                    m_replies.removeAll(reply);
-                } else if (error == QNetworkReply::AuthenticationRequiredError) {
-                    // authentication is required
-                    reportAuthenticationRequired(optionIndex, m_realm);
-                    reply->deleteLater();
-                    m_replies.removeAll(reply);
-                    // wrong to report a failed download here?
-                    reportFinalDownloadStatus(optionIndex, false, reasonForFail, error);
-                } else {
-                    // some other error occurred
-                    reply->deleteLater();
-                    m_replies.removeAll(reply);
-                    reportFinalDownloadStatus(optionIndex, false, reasonForFail, error);
-                }
+    for (QNetworkReply *const candidate : std::as_const(m_replies)) {
+        if (candidate->property("optionindex").toUInt(&ok) == optionIndex && ok) {
+            reply = candidate;
+            break;
+        }
+    }
+    if (!reply) {
+        return;
+    }
+    QString reasonForFail;
+    QNetworkReply::NetworkError error = reply->error();
+    if (error != QNetworkReply::NoError) {
+        reasonForFail = reply->errorString();
+        if ((error == QNetworkReply::OperationCanceledError) && (status() == DownloadStatus::Interrupting)) {
+            // download has been interrupted by the user
+            reportDownloadInterrupted(optionIndex);
+            reply->deleteLater();
+            m_replies.removeAll(reply);
+        } else if (error == QNetworkReply::AuthenticationRequiredError) {
+            // authentication is required
+            reportAuthenticationRequired(optionIndex, m_realm);
+            reply->deleteLater();
+            m_replies.removeAll(reply);
+            // wrong to report a failed download here?
+            reportFinalDownloadStatus(optionIndex, false, reasonForFail, error);
+        } else if (ProxyPool::isProxyError(error) && reply->property("proxyindex").toInt() >= 0
+            && m_triedProxies.size() < ProxyPool::instance().size() && !options().at(optionIndex).bytesWritten()
+            && !options().at(optionIndex).isBuffering()) {
+            // the proxy failed before any data has been received so retry using a proxy of the pool which has not been tried yet
+            reply->deleteLater();
+            m_replies.removeAll(reply);
+            ++m_totalRetries;
+            startRequest(optionIndex);
+        } else {
+            // some other error occurred
+            reply->deleteLater();
+            m_replies.removeAll(reply);
+            reportFinalDownloadStatus(optionIndex, false, reasonForFail, error);
+        }
+    } else {
+        // no error occurred
+        // check if there's a redirection
+        QVariant redirectionTarget = reply->attribute(QNetworkRequest::RedirectionTargetAttribute);
+        reply->deleteLater();
+        m_replies.removeAll(reply);
+        if (!redirectionTarget.isNull()) {
+            // there's a redirection available
+            QUrl newUrl = downloadUrl().resolved(redirectionTarget.toUrl());
+            QString newOption;
+            int counter = 1;
+            size_t option = optionIndex;
+            while (option != options().at(option).redirectionOf()) {
+                option = options().at(option).redirectionOf();
+                ++counter;
+            }
+            if (counter > 1) {
+                newOption = tr("%1 - redirection (%2)").arg(optionName(option)).arg(counter);
             } else {
-                // no error occurred
-                // check if there's a redirection
-                QVariant redirectionTarget = reply->attribute(QNetworkRequest::RedirectionTargetAttribute);
-                reply->deleteLater();
-                m_replies.removeAll(reply);
-                if (!redirectionTarget.isNull()) {
-                    // there's a redirection available
-                    QUrl newUrl = downloadUrl().resolved(redirectionTarget.toUrl());
-                    QString newOption;
-                    int counter = 1;
-                    size_t option = optionIndex;
-                    while (option != options().at(option).redirectionOf()) {
-                        option = options().at(option).redirectionOf();
-                        ++counter;
-                    }
-                    if (counter > 1) {
-                        newOption = tr("%1 - redirection (%2)").arg(optionName(option)).arg(counter);
-                    } else {
-                        newOption = tr("%1 - redirection").arg(optionName(option));
-                    }
-                    addDownloadUrl(newOption, newUrl, chosenOption());
-                    reportRedirectionAvailable(optionIndex);
-                } else {
-                    // the download has been finished successfully
-                    reportFinalDownloadStatus(optionIndex, true);
-                }
+                newOption = tr("%1 - redirection").arg(optionName(option));
             }
-            return;
+            addDownloadUrl(newOption, newUrl, chosenOption());
+            reportTransferRedirect(optionIndex);
+            reportRedirectionAvailable(optionIndex);
+        } else {
+            // the download has been finished successfully
+            reportFinalDownloadStatus(optionIndex, true);
         }
     }
 }
@@ -192,6 +348,7 @@ bool HttpDownload::followRedirection(size_t redirectionOptionIndex)
         if (originalIndex < availableOptionCount()) {
             finalizeOutputDevice(originalIndex);
         }
+        m_triedProxies.clear();
         startRequest(redirectionOptionIndex);
         return true;
     }
@@ -234,8 +391,91 @@ void HttpDownload::slotSslErrors(QNetworkReply *reply, const QList<QSslError> &s
         }
     }
 }
+
+/*!
+ * \brief Handles the encrypted signal emitted by the network reply.
+ */
+void HttpDownload::slotEncrypted()
+{
+    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+    reportReplyTransferPhase(reply, TransferTimings::Phase::Encrypted);
+    storeSessionTicket(reply);
+}
+
+/*!
+ * \brief Stores the TLS session ticket of the specified \a reply in the SslSessionCache.
+ *
+ * This is done when the connection has been encrypted (so downloads started in the meantime can already
+ * use it) and again when the reply has finished because with TLS 1.3 the server sends the ticket after
+ * the handshake.
+ */
+void HttpDownload::storeSessionTicket(QNetworkReply *reply)
+{
+    const auto sessionKey = reply->property("sslsessionkey").toString();
+    if (sessionKey.isEmpty()) {
+        return;
+    }
+    const auto sslConfig = reply->sslConfiguration();
+    SslSessionCache::instance().storeSessionTicket(sessionKey, sslConfig.sessionTicket(), sslConfig.sessionTicketLifeTimeHint());
+}
 #endif
 
+/*!
+ * \brief Determines the size of the chosen option via a HEAD request.
+ * \remarks Only GET downloads are probed because the size of the response to a POST request can not be
+ *          determined without actually sending the request.
+ */
+void HttpDownload::doProbeExpectedSize()
+{
+    if (m_method != HttpDownloadMethod::Get) {
+        return;
+    }
+    QNetworkRequest request(m_request);
+    request.setUrl(downloadUrl(chosenOption()));
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, Http2Policy::instance().isAllowed(request.url()));
+    if (request.hasRawHeader("Range")) {
+        request.setRawHeader("Range", QByteArray());
+    }
+    if (!userAgent().isEmpty()) {
+        request.setHeader(QNetworkRequest::UserAgentHeader, userAgent().toLocal8Bit());
+    }
+    // follow redirections so the size of the actual file is determined rather than the size of the redirection
+    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
+    // use the pool like regular requests so ejected proxies are avoided and the request is accounted
+    auto &proxyPool = ProxyPool::instance();
+    const auto proxyIndex = proxyPool.acquire();
+    m_mgr->setProxy(proxyIndex >= 0 ? proxyPool.proxy(proxyIndex) : proxy());
+    QNetworkReply *reply = m_mgr->head(request);
+    // the chosen option might change until the probe has finished
+    reply->setProperty("optionindex", QVariant::fromValue(chosenOption()));
+    reply->setProperty("requesttime", QDateTime::currentMSecsSinceEpoch());
+    reply->setProperty("proxyindex", proxyIndex);
+    reply->setProperty("proxygeneration", proxyPool.generation());
+    // take ownership so the reply is aborted when the download is destroyed before the probe has finished
+    reply->setParent(this);
+    connect(reply, &QNetworkReply::finished, this, &HttpDownload::slotProbeFinished);
+}
+
+/*!
+ * \brief Handles the finished signal emitted by the network reply of the HEAD request sent by doProbeExpectedSize().
+ */
+void HttpDownload::slotProbeFinished()
+{
+    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+    releaseProxy(reply);
+    // the Content-Length of other responses (eg. redirections which could not be followed) is not the size of the file
+    bool ok;
+    const auto optionIndex = reply->property("optionindex").toUInt(&ok);
+    if (ok && optionIndex == chosenOption() && reply->error() == QNetworkReply::NoError
+        && reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 200) {
+        const auto size = reply->header(QNetworkRequest::ContentLengthHeader).toLongLong(&ok);
+        if (ok) {
+            reportExpectedSize(size);
+        }
+    }
+    reply->deleteLater();
+}
+
 /*!
  * \brief Handles the finished signal emitted by the network reply.
  */
@@ -243,8 +483,13 @@ void HttpDownload::slotFinished()
 {
     bool ok;
     QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+#ifndef QT_NO_OPENSSL
+    storeSessionTicket(reply);
+#endif
+    releaseProxy(reply);
     auto optionIndex = reply->property("optionindex").toUInt(&ok);
     if (ok) {
+        reportTransferPhase(optionIndex, TransferTimings::Phase::Finished);
         if (reply->bytesAvailable()) {
             reportNewDataToBeWritten(optionIndex, reply);
         }
@@ -252,18 +497,55 @@ void HttpDownload::slotFinished()
     }
 }
 
+#if QT_VERSION >= QT_VERSION_CHECK(6, 3, 0)
+/*!
+ * \brief Handles the socket started connecting signal emitted by the network reply.
+ */
+void HttpDownload::slotSocketStartedConnecting()
+{
+    reportReplyTransferPhase(qobject_cast<QNetworkReply *>(sender()), TransferTimings::Phase::ConnectingStarted);
+}
+
+/*!
+ * \brief Handles the request sent signal emitted by the network reply.
+ */
+void HttpDownload::slotRequestSent()
+{
+    reportReplyTransferPhase(qobject_cast<QNetworkReply *>(sender()), TransferTimings::Phase::RequestSent);
+}
+#endif
+
+/*!
+ * \brief Reports that the transfer of the specified \a reply reached the specified \a phase.
+ * \remarks Does nothing if the reply does not belong to an option (e. g. replies of doProbeExpectedSize()).
+ */
+void HttpDownload::reportReplyTransferPhase(QNetworkReply *reply, TransferTimings::Phase phase)
+{
+    bool ok;
+    const auto optionIndex = reply->property("optionindex").toUInt(&ok);
+    if (ok) {
+        reportTransferPhase(optionIndex, phase);
+    }
+}
+
 /*!
  * \brief Handles the ready read signal emitted by the network reply.
  */
 void HttpDownload::slotReadyRead()
 {
+    TRACE_SCOPE("HttpDownload::slotReadyRead");
     QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+    if (!reply->property("firstbytetime").isValid()) {
+        reply->setProperty("firstbytetime", QDateTime::currentMSecsSinceEpoch());
+        reportReplyTransferPhase(reply, TransferTimings::Phase::FirstByte);
+    }
     if (!reply->property("headerread").toBool()) {
-        QVariant title = reply->header(QNetworkRequest::ContentDispositionHeader);
-        if (title.isValid()) {
-            ContentDispositionParser contentDisposition(title.toString());
-            contentDisposition.pharse();
-            QString fileName = contentDisposition.fileName();
+        const QByteArray contentDispositionHeader = reply->rawHeader(QByteArrayLiteral("Content-Disposition"));
+        if (!contentDispositionHeader.isEmpty()) {
+            ContentDispositionParser contentDisposition(
+                std::string_view(contentDispositionHeader.constData(), static_cast<std::size_t>(contentDispositionHeader.size())));
+            contentDisposition.parse();
+            const QString fileName = contentDisposition.fileName();
             if (!fileName.isEmpty()) {
                 setTitleFromFilename(fileName);
                 reply->setProperty("headerread", true);
@@ -287,6 +569,8 @@ void HttpDownload::slotDownloadProgress(qint64 bytesReceived, qint64 bytesToRece
     bool ok;
     auto optionIndex = reply->property("optionindex").toUInt(&ok);
     if (ok) {
+        reply->setProperty("bytesreceived", bytesReceived);
+        adjustReadBufferSize(reply, optionIndex, bytesReceived);
         reportDownloadProgressUpdate(optionIndex, bytesReceived, bytesToReceive);
     }
 }
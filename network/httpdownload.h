@@ -86,6 +86,7 @@ public:
     void abortDownload();
     void checkStatusAndClear(size_t optionIndex);
     bool followRedirection(size_t redirectionOptionIndex);
+    void doProbeExpectedSize();
     HttpDownloadMethod method() const;
     QString rawCookies() const;
     QList<QNetworkCookie> cookies() const;
@@ -98,33 +99,59 @@ public:
     bool isInitiatingInstantlyRecommendable() const;
     bool supportsRange() const;
     QString typeName() const;
+    static quint64 totalRetries();
     //bool isPending(QNetworkReply *reply) const;
 
 private Q_SLOTS:
     void slotFinished();
     void slotReadyRead();
     void slotDownloadProgress(qint64 bytesReceived, qint64 bytesToReceive);
+    void slotProbeFinished();
+#if QT_VERSION >= QT_VERSION_CHECK(6, 3, 0)
+    void slotSocketStartedConnecting();
+    void slotRequestSent();
+#endif
     void slotAuthenticationRequired(QNetworkReply *reply, QAuthenticator *authenticator);
 #ifndef QT_NO_OPENSSL
     void slotSslErrors(QNetworkReply *reply, const QList<QSslError> &sslErrors);
+    void slotEncrypted();
 #endif
 
 private:
     void startRequest(size_t optionIndex);
+#ifndef QT_NO_OPENSSL
+    static void storeSessionTicket(QNetworkReply *reply);
+#endif
     static QString readTitleFromUrl(const QUrl &url);
+    static void releaseProxy(QNetworkReply *reply);
+    void reportReplyTransferPhase(QNetworkReply *reply, TransferTimings::Phase phase);
+    void adjustReadBufferSize(QNetworkReply *reply, std::size_t optionIndex, qint64 bytesReceived);
     static QNetworkAccessManager *m_mgr;
+    static int m_activeReplies;
+    static quint64 m_totalRetries;
     QNetworkRequest m_request;
     QList<QNetworkReply *> m_replies;
     QByteArray m_postData;
     HttpDownloadMethod m_method;
     QVariant m_setCookie;
     int m_redirectionIndex;
+    QList<int> m_triedProxies;
+    unsigned int m_triedProxiesGeneration;
     QString m_realm;
 };
 
+/*!
+ * \brief Returns the number of requests which have been retried (e. g. using another proxy) by all HTTP downloads.
+ */
+inline quint64 HttpDownload::totalRetries()
+{
+    return m_totalRetries;
+}
+
 inline void HttpDownload::doDownload()
 {
     if (isValidOptionChosen()) {
+        m_triedProxies.clear();
         startRequest(chosenOption());
     }
 }
@@ -32,6 +32,11 @@ void HttpDownloadWithInfoRequst::doInit()
     // get the info request
     m_infoDownload.reset(infoRequestDownload(success, reasonForFail));
     if (success) {
+        // the ID is usually known at this point so skip the request if it failed recently
+        if (reportKnownInitiationFailure()) {
+            m_infoDownload.reset();
+            return;
+        }
         // the request could be constructed successfully
         if (!m_infoDownload) {
             // no request needed (at this time), just call evalVideoInformation()
@@ -65,7 +70,7 @@ void HttpDownloadWithInfoRequst::infoRequestChangedStatus(Download *download)
 {
     switch (download->status()) {
     case DownloadStatus::Failed:
-        reportInitiated(false, tr("Couldn't retrieve the video information. %1").arg(statusInfo()));
+        reportInitiated(false, tr("Couldn't retrieve the video information. %1").arg(download->statusInfo()), download->networkError());
         break;
     case DownloadStatus::Ready:
         if (m_infoDownload->isValidOptionChosen()) {
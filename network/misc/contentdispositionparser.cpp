@@ -1,132 +1,218 @@
 #include "./contentdispositionparser.h"
+#include "./urlencodedformreader.h"
+
+#include "../../application/utils.h"
+
+#include <QByteArray>
+
+#include <algorithm>
+
+using namespace Application;
 
 namespace Network {
 
+/*!
+ * \brief Returns whether \a c is whitespace in the sense of RFC 7230 ("OWS").
+ */
+static bool isWhitespace(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+/*!
+ * \brief Returns the specified \a value without leading and trailing whitespace.
+ */
+static std::string_view trimmed(std::string_view value)
+{
+    while (!value.empty() && isWhitespace(value.front())) {
+        value.remove_prefix(1);
+    }
+    while (!value.empty() && isWhitespace(value.back())) {
+        value.remove_suffix(1);
+    }
+    return value;
+}
+
+/*!
+ * \brief Returns the specified \a value with everything up to the next ";" removed.
+ */
+static std::string_view fromNextSeparator(std::string_view value)
+{
+    const auto separator = value.find(';');
+    return separator == std::string_view::npos ? std::string_view() : value.substr(separator);
+}
+
 /*!
  * \class ContentDispositionParser
- * \brief The ContentDispositionParser class parses a HTTP content disposition.
+ * \brief The ContentDispositionParser class parses a HTTP content disposition (RFC 6266).
+ *
+ * The header is tokenized in a single pass. The disposition type and the parameters are kept as views on the
+ * specified header so only the file name is decoded (and allocated) when it is actually requested. Invalid parts
+ * of the header are skipped so file names can still be obtained from sloppy servers.
  */
 
 /*!
  * \brief Constructs a new ContentDispositionParser for the specified \a contentDisposition.
+ * \remarks The \a contentDisposition must outlive the parser.
  */
-ContentDispositionParser::ContentDispositionParser(const QString &contentDisposition)
+ContentDispositionParser::ContentDispositionParser(std::string_view contentDisposition)
+    : m_contentDisposition(contentDisposition)
 {
-    this->m_contentDisposition = contentDisposition;
 }
 
 /*!
- * \brief Adds data (internally used only).
+ * \brief Parses the content disposition.
  */
-void ContentDispositionParser::addData(QString fieldName, QString value)
+void ContentDispositionParser::parse()
 {
-    while (fieldName.length() > 0 && fieldName.at(0) == ' ') {
-        fieldName = fieldName.mid(1);
+    m_fileName = m_extendedFileName = Parameter();
+    m_dispositionType = trimmed(m_contentDisposition.substr(0, m_contentDisposition.find(';')));
+    if (m_dispositionType.find('=') == std::string_view::npos) {
+        m_parameters = fromNextSeparator(m_contentDisposition);
+    } else {
+        // the disposition type is omitted by some servers
+        m_dispositionType = std::string_view();
+        m_parameters = m_contentDisposition;
+    }
+    std::string_view parameters = m_parameters;
+    for (Parameter parameter; readParameter(parameters, parameter);) {
+        if (m_fileName.name.empty() && equalsIgnoringCase(parameter.name, "filename")) {
+            m_fileName = parameter;
+        } else if (m_extendedFileName.name.empty() && equalsIgnoringCase(parameter.name, "filename*")) {
+            m_extendedFileName = parameter;
+        }
     }
-    while (value.length() > 0 && value.at(0) == ' ') {
-        value = value.mid(1);
+}
+
+/*!
+ * \brief Returns whether the content is an attachment.
+ */
+bool ContentDispositionParser::isAttachment() const
+{
+    return equalsIgnoringCase(m_dispositionType, "attachment");
+}
+
+/*!
+ * \brief Returns the file name.
+ *
+ * The "filename*" parameter takes precedence over the "filename" parameter if its character set is supported.
+ * Only the last segment of the file name is returned because a file name must not specify a directory.
+ */
+QString ContentDispositionParser::fileName() const
+{
+    QString fileName;
+    if (!m_extendedFileName.name.empty()) {
+        fileName = decodedExtendedValue(m_extendedFileName.value);
     }
-    while (fieldName.endsWith(' ')) {
-        fieldName = fieldName.mid(0, fieldName.length() - 1);
+    if (fileName.isEmpty() && !m_fileName.name.empty()) {
+        fileName = m_fileName.quoted ? unquoted(m_fileName.value)
+                                     : QString::fromUtf8(m_fileName.value.data(), static_cast<int>(m_fileName.value.size()));
     }
-    while (value.endsWith(' ')) {
-        value = value.mid(0, value.length() - 1);
+    const auto separatorIndex = std::max(fileName.lastIndexOf(QLatin1Char('/')), fileName.lastIndexOf(QLatin1Char('\\')));
+    if (separatorIndex >= 0) {
+        fileName.remove(0, separatorIndex + 1);
     }
+    return fileName;
+}
 
-    if (fieldName.compare("attachment", Qt::CaseInsensitive)) {
-        m_attachment = true;
-    } else if (fieldName.compare("filename", Qt::CaseInsensitive)) {
-        m_fileName = value;
+/*!
+ * \brief Returns the raw value of the parameter with the specified \a name or an empty view if there is no such parameter.
+ * \remarks The \a name must be specified in lower case. Quoted pairs in the value are not resolved.
+ */
+std::string_view ContentDispositionParser::parameter(std::string_view name) const
+{
+    std::string_view parameters = m_parameters;
+    for (Parameter parameter; readParameter(parameters, parameter);) {
+        if (equalsIgnoringCase(parameter.name, name)) {
+            return parameter.value;
+        }
     }
-
-    m_data.insert(fieldName, value);
+    return std::string_view();
 }
 
 /*!
- * \brief Parses the content disposition.
+ * \brief Reads the next parameter from the specified \a parameters and removes it from \a parameters.
+ * \returns Returns false if there are no further parameters.
  */
-void ContentDispositionParser::pharse()
+bool ContentDispositionParser::readParameter(std::string_view &parameters, Parameter &parameter)
 {
-    bool inQuotationMarks = false;
-    PharsingPosition pos = FieldName;
-    QString fieldName;
-    QString value;
-    for (QChar c : m_contentDisposition) {
-        if (c == '\"') {
-            inQuotationMarks = !inQuotationMarks;
-        } else if (c == ';') {
-            if (inQuotationMarks) {
-                switch (pos) {
-                case FieldName:
-                    fieldName.append(c);
-                    break;
-                case Value:
-                    value.append(c);
-                    break;
-                }
-            } else {
-                addData(fieldName, value);
-                fieldName.clear();
-                value.clear();
-                pos = FieldName;
-            }
-        } else if (c == '=') {
-            if (inQuotationMarks) {
-                switch (pos) {
-                case FieldName:
-                    fieldName.append(c);
-                    break;
-                case Value:
-                    value.append(c);
-                    break;
-                }
-            } else {
-                switch (pos) {
-                case FieldName:
-                    pos = Value;
-                    break;
-                case Value:
-                    value.append(c);
-                    break;
+    for (;;) {
+        while (!parameters.empty() && (parameters.front() == ';' || isWhitespace(parameters.front()))) {
+            parameters.remove_prefix(1);
+        }
+        if (parameters.empty()) {
+            return false;
+        }
+        const auto nameEnd = parameters.find_first_of("=;");
+        parameter.name = trimmed(parameters.substr(0, nameEnd));
+        if (nameEnd == std::string_view::npos || parameters[nameEnd] == ';') {
+            // skip parameters without value
+            parameters = fromNextSeparator(parameters);
+            continue;
+        }
+        parameters = trimmed(parameters.substr(nameEnd + 1));
+        parameter.quoted = !parameters.empty() && parameters.front() == '"';
+        if (parameter.quoted) {
+            std::size_t end = 1;
+            for (; end < parameters.size() && parameters[end] != '"'; ++end) {
+                if (parameters[end] == '\\') {
+                    ++end;
                 }
             }
+            end = std::min(end, parameters.size());
+            parameter.value = parameters.substr(1, end - 1);
+            parameters = fromNextSeparator(parameters.substr(std::min(end + 1, parameters.size())));
         } else {
-            switch (pos) {
-            case FieldName:
-                fieldName.append(c);
-                break;
-            case Value:
-                value.append(c);
-                break;
-            }
+            parameter.value = trimmed(parameters.substr(0, parameters.find(';')));
+            parameters = fromNextSeparator(parameters);
+        }
+        if (!parameter.name.empty()) {
+            return true;
         }
-    }
-    if (!fieldName.isEmpty()) {
-        addData(fieldName, value);
     }
 }
 
 /*!
- * \brief Returns the file name.
+ * \brief Returns the specified extended \a value (RFC 5987) decoded or an empty string if the value is invalid or its character
+ *        set is not supported.
  */
-const QString &ContentDispositionParser::fileName()
+QString ContentDispositionParser::decodedExtendedValue(std::string_view value)
 {
-    return m_fileName;
+    const auto charsetEnd = value.find('\'');
+    if (charsetEnd == std::string_view::npos) {
+        return QString();
+    }
+    const auto languageEnd = value.find('\'', charsetEnd + 1);
+    if (languageEnd == std::string_view::npos) {
+        return QString();
+    }
+    const auto charset = value.substr(0, charsetEnd);
+    if (equalsIgnoringCase(charset, "utf-8")) {
+        return QString::fromUtf8(UrlEncodedFormReader::percentDecoded(value.substr(languageEnd + 1)));
+    } else if (equalsIgnoringCase(charset, "iso-8859-1")) {
+        return QString::fromLatin1(UrlEncodedFormReader::percentDecoded(value.substr(languageEnd + 1)));
+    }
+    return QString();
 }
 
 /*!
- * \brief Returns whether the content is an attachment.
+ * \brief Returns the specified quoted \a value with quoted pairs resolved.
+ * \remarks The value is assumed to be UTF-8 encoded which is what browsers assume as well.
  */
-bool ContentDispositionParser::isAttachment()
+QString ContentDispositionParser::unquoted(std::string_view value)
 {
-    return m_attachment;
+    if (value.find('\\') == std::string_view::npos) {
+        return QString::fromUtf8(value.data(), static_cast<int>(value.size()));
+    }
+    QByteArray resolved;
+    resolved.reserve(static_cast<int>(value.size()));
+    for (std::size_t index = 0; index < value.size(); ++index) {
+        if (value[index] == '\\' && index + 1 < value.size()) {
+            ++index;
+        }
+        resolved.append(value[index]);
+    }
+    return QString::fromUtf8(resolved);
 }
 
-/*!
- * \brief Returns the data.
- */
-const QMap<QString, QString> &ContentDispositionParser::data()
-{
-    return m_data;
-}
 } // namespace Network
@@ -1,35 +1,51 @@
-#ifndef CONTENTDISPOSITIONPHARSER_H
-#define CONTENTDISPOSITIONPHARSER_H
+#ifndef NETWORK_CONTENTDISPOSITIONPARSER_H
+#define NETWORK_CONTENTDISPOSITIONPARSER_H
 
-#include <QMap>
 #include <QString>
 
+#include <string_view>
+
 namespace Network {
 
 class ContentDispositionParser {
 public:
-    ContentDispositionParser(const QString &contentDisposition);
-    void pharse();
-    const QString &fileName();
-    bool isAttachment();
-    const QMap<QString, QString> &data();
+    explicit ContentDispositionParser(std::string_view contentDisposition);
+
+    void parse();
+    std::string_view dispositionType() const;
+    bool isAttachment() const;
+    QString fileName() const;
+    std::string_view parameter(std::string_view name) const;
 
 private:
     /*!
-     * \brief Specifies the parsing position.
+     * \brief The Parameter struct holds a parameter as views on the parsed content disposition.
      */
-    enum PharsingPosition {
-        FieldName, /**< file name */
-        Value /**< value */
+    struct Parameter {
+        std::string_view name;
+        std::string_view value; /**< the value without enclosing quotation marks; quoted pairs are not resolved yet */
+        bool quoted = false;
     };
 
-    void addData(QString fieldName, QString value);
+    static bool readParameter(std::string_view &parameters, Parameter &parameter);
+    static QString decodedExtendedValue(std::string_view value);
+    static QString unquoted(std::string_view value);
 
-    QString m_contentDisposition;
-    QString m_fileName;
-    bool m_attachment;
-    QMap<QString, QString> m_data;
+    std::string_view m_contentDisposition;
+    std::string_view m_parameters;
+    std::string_view m_dispositionType;
+    Parameter m_fileName;
+    Parameter m_extendedFileName;
 };
+
+/*!
+ * \brief Returns the disposition type, e.g. "inline" or "attachment".
+ */
+inline std::string_view ContentDispositionParser::dispositionType() const
+{
+    return m_dispositionType;
+}
+
 } // namespace Network
 
-#endif // CONTENTDISPOSITIONPHARSER_H
+#endif // NETWORK_CONTENTDISPOSITIONPARSER_H
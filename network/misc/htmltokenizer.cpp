@@ -0,0 +1,324 @@
+#include "./htmltokenizer.h"
+
+namespace Network {
+
+/*!
+ * \brief Specifies the max. size of a tag; longer tags are considered garbage and skipped.
+ */
+constexpr int maxTagSize = 64 * 1024;
+
+/*!
+ * \brief Returns whether \a c is considered whitespace by HTML.
+ */
+static inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
+}
+
+/*!
+ * \brief Returns whether \a c is an ASCII letter.
+ */
+static inline bool isLetter(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+/*!
+ * \brief Returns \a c converted to lower case if it is an ASCII letter.
+ */
+static inline char toLower(char c)
+{
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+/*!
+ * \class HtmlTokenizer
+ * \brief The HtmlTokenizer class extracts the title and the anchors of an HTML document.
+ *
+ * The document is processed in a single pass directly on the UTF-8 encoded bytes. It can be fed in
+ * arbitrary chunks as it arrives; only the current tag and the contents of the current anchor or title
+ * are buffered. Comments as well as the contents of script and style elements are skipped.
+ *
+ * The extracted values are raw; entities are not decoded (see Application::replaceHtmlEntities()).
+ */
+
+/*!
+ * \brief Constructs a new tokenizer.
+ */
+HtmlTokenizer::HtmlTokenizer()
+{
+    reset();
+}
+
+/*!
+ * \brief Processes the specified \a data which might be an arbitrary part of the document.
+ */
+void HtmlTokenizer::feed(const char *data, std::size_t size)
+{
+    for (const char *const end = data + size; data != end; ++data) {
+        const char c = *data;
+        switch (m_state) {
+        case State::Text:
+            if (c == '<') {
+                m_state = State::TagOpen;
+            } else if (m_capturingLink || m_capturingTitle) {
+                appendToCapture(c);
+            }
+            break;
+        case State::TagOpen:
+            if (isLetter(c) || c == '/' || c == '!' || c == '?') {
+                m_tag = QByteArray(1, c);
+                m_quote = 0;
+                m_lastNonSpace = c;
+                m_state = State::Tag;
+            } else {
+                // not markup, the '<' is meant literally
+                appendToCapture('<');
+                if (c != '<') {
+                    appendToCapture(c);
+                    m_state = State::Text;
+                }
+            }
+            break;
+        case State::Tag:
+            if (m_quote) {
+                if (c == m_quote) {
+                    m_quote = 0;
+                }
+                m_tag += c;
+            } else if (c == '>') {
+                handleTag();
+                break;
+            } else {
+                if ((c == '"' || c == '\'') && m_lastNonSpace == '=') {
+                    m_quote = c;
+                }
+                if (!isSpace(c)) {
+                    m_lastNonSpace = c;
+                }
+                m_tag += c;
+                if (m_tag.size() == 3 && m_tag == "!--") {
+                    m_tag.clear();
+                    m_dashes = 0;
+                    m_state = State::Comment;
+                    break;
+                }
+            }
+            if (m_tag.size() > maxTagSize) {
+                m_tag.clear();
+                m_state = State::Text;
+            }
+            break;
+        case State::Comment:
+            if (c == '-') {
+                ++m_dashes;
+            } else {
+                if (c == '>' && m_dashes >= 2) {
+                    m_state = State::Text;
+                }
+                m_dashes = 0;
+            }
+            break;
+        case State::RawText:
+            if (toLower(c) == m_rawTextEnd.at(m_rawTextMatched)) {
+                if (++m_rawTextMatched == m_rawTextEnd.size()) {
+                    m_state = State::RawTextClosing;
+                }
+            } else {
+                m_rawTextMatched = c == '<' ? 1 : 0;
+            }
+            break;
+        case State::RawTextClosing:
+            if (c == '>') {
+                m_state = State::Text;
+            }
+            break;
+        }
+    }
+}
+
+/*!
+ * \brief Finishes processing the document; an anchor which has not been closed is taken as well.
+ */
+void HtmlTokenizer::finish()
+{
+    if (m_capturingLink) {
+        emitLink();
+    }
+    m_capturingTitle = false;
+    m_state = State::Text;
+    m_tag.clear();
+}
+
+/*!
+ * \brief Resets the tokenizer so another document can be processed.
+ */
+void HtmlTokenizer::reset()
+{
+    m_state = State::Text;
+    m_tag.clear();
+    m_quote = 0;
+    m_lastNonSpace = 0;
+    m_dashes = 0;
+    m_rawTextEnd.clear();
+    m_rawTextMatched = 0;
+    m_capturingTitle = false;
+    m_capturingLink = false;
+    m_titleText.clear();
+    m_linkHref.clear();
+    m_linkText.clear();
+    m_title.clear();
+    m_hasTitle = false;
+    m_links.clear();
+}
+
+/*!
+ * \brief Returns the links found since the last call.
+ */
+std::vector<HtmlTokenizer::Link> HtmlTokenizer::takeLinks()
+{
+    std::vector<Link> links;
+    links.swap(m_links);
+    return links;
+}
+
+/*!
+ * \brief Handles the tag which has just been read completely.
+ */
+void HtmlTokenizer::handleTag()
+{
+    m_state = State::Text;
+    bool closing;
+    const QByteArray name = tagName(m_tag, closing);
+    if (name == "a") {
+        if (m_capturingLink) {
+            emitLink(); // anchors can not be nested
+        }
+        if (!closing) {
+            m_linkHref = attribute(m_tag, "href");
+            m_capturingLink = true;
+        }
+    } else if (name == "title" && !m_hasTitle) {
+        if (!closing) {
+            m_capturingTitle = true;
+        } else if (m_capturingTitle) {
+            m_title = QString::fromUtf8(m_titleText);
+            m_titleText.clear();
+            m_hasTitle = true;
+            m_capturingTitle = false;
+        }
+    } else if (!closing && (name == "script" || name == "style") && !m_tag.endsWith('/')) {
+        m_rawTextEnd = "</" + name;
+        m_rawTextMatched = 0;
+        m_state = State::RawText;
+    } else if (m_capturingLink || m_capturingTitle) {
+        // keep other tags so line breaks and formatting are handled when converting the text
+        appendToCapture('<');
+        for (const char c : m_tag) {
+            appendToCapture(c);
+        }
+        appendToCapture('>');
+    }
+    m_tag.clear();
+}
+
+/*!
+ * \brief Appends \a c to the contents of the current anchor and/or title.
+ */
+void HtmlTokenizer::appendToCapture(char c)
+{
+    if (m_capturingLink) {
+        m_linkText += c;
+    }
+    if (m_capturingTitle) {
+        m_titleText += c;
+    }
+}
+
+/*!
+ * \brief Adds the current anchor to the found links if it has an href attribute.
+ */
+void HtmlTokenizer::emitLink()
+{
+    if (!m_linkHref.isEmpty()) {
+        m_links.emplace_back(Link{ QString::fromUtf8(m_linkHref), QString::fromUtf8(m_linkText) });
+    }
+    m_linkHref.clear();
+    m_linkText.clear();
+    m_capturingLink = false;
+}
+
+/*!
+ * \brief Returns the name of the specified \a tag in lower case and whether it is a \a closing tag.
+ */
+QByteArray HtmlTokenizer::tagName(const QByteArray &tag, bool &closing)
+{
+    int i = 0;
+    closing = tag.startsWith('/');
+    if (closing) {
+        ++i;
+    }
+    QByteArray name;
+    for (; i < tag.size() && !isSpace(tag.at(i)) && tag.at(i) != '/'; ++i) {
+        name += toLower(tag.at(i));
+    }
+    return name;
+}
+
+/*!
+ * \brief Returns the raw value of the attribute with the specified \a name (in lower case) of the specified \a tag.
+ */
+QByteArray HtmlTokenizer::attribute(const QByteArray &tag, const char *name)
+{
+    const int size = tag.size();
+    int i = 0;
+    // skip tag name
+    while (i < size && !isSpace(tag.at(i)) && tag.at(i) != '/') {
+        ++i;
+    }
+    while (i < size) {
+        // read attribute name
+        while (i < size && (isSpace(tag.at(i)) || tag.at(i) == '/')) {
+            ++i;
+        }
+        const int nameBegin = i;
+        while (i < size && !isSpace(tag.at(i)) && tag.at(i) != '=' && tag.at(i) != '/') {
+            ++i;
+        }
+        const QByteArray attributeName = tag.mid(nameBegin, i - nameBegin).toLower();
+        while (i < size && isSpace(tag.at(i))) {
+            ++i;
+        }
+        if (i >= size || tag.at(i) != '=') {
+            if (attributeName == name) {
+                return QByteArray();
+            }
+            continue; // attribute without value
+        }
+        // read attribute value
+        ++i;
+        while (i < size && isSpace(tag.at(i))) {
+            ++i;
+        }
+        int valueBegin = i, valueEnd;
+        if (i < size && (tag.at(i) == '"' || tag.at(i) == '\'')) {
+            const char quote = tag.at(i);
+            valueBegin = ++i;
+            while (i < size && tag.at(i) != quote) {
+                ++i;
+            }
+            valueEnd = i++;
+        } else {
+            while (i < size && !isSpace(tag.at(i))) {
+                ++i;
+            }
+            valueEnd = i;
+        }
+        if (attributeName == name) {
+            return tag.mid(valueBegin, valueEnd - valueBegin);
+        }
+    }
+    return QByteArray();
+}
+
+} // namespace Network
@@ -0,0 +1,85 @@
+#ifndef NETWORK_HTMLTOKENIZER_H
+#define NETWORK_HTMLTOKENIZER_H
+
+#include <QByteArray>
+#include <QString>
+
+#include <vector>
+
+namespace Network {
+
+class HtmlTokenizer {
+public:
+    /*!
+     * \brief The Link struct holds the raw href attribute and the raw contents of an anchor.
+     * \remarks Entities are not decoded and nested tags are kept within the text.
+     */
+    struct Link {
+        QString href;
+        QString text;
+    };
+
+    HtmlTokenizer();
+
+    void feed(const char *data, std::size_t size);
+    void feed(const QByteArray &data);
+    void finish();
+    void reset();
+    bool hasTitle() const;
+    const QString &title() const;
+    std::vector<Link> takeLinks();
+
+private:
+    enum class State { Text, TagOpen, Tag, Comment, RawText, RawTextClosing };
+
+    void handleTag();
+    void appendToCapture(char c);
+    void emitLink();
+    static QByteArray tagName(const QByteArray &tag, bool &closing);
+    static QByteArray attribute(const QByteArray &tag, const char *name);
+
+    State m_state;
+    QByteArray m_tag;
+    char m_quote;
+    char m_lastNonSpace;
+    int m_dashes;
+    QByteArray m_rawTextEnd;
+    int m_rawTextMatched;
+    bool m_capturingTitle;
+    bool m_capturingLink;
+    QByteArray m_titleText;
+    QByteArray m_linkHref;
+    QByteArray m_linkText;
+    QString m_title;
+    bool m_hasTitle;
+    std::vector<Link> m_links;
+};
+
+/*!
+ * \brief Feeds the specified \a data.
+ */
+inline void HtmlTokenizer::feed(const QByteArray &data)
+{
+    feed(data.data(), static_cast<std::size_t>(data.size()));
+}
+
+/*!
+ * \brief Returns whether the title of the document has been read.
+ */
+inline bool HtmlTokenizer::hasTitle() const
+{
+    return m_hasTitle;
+}
+
+/*!
+ * \brief Returns the raw title of the document.
+ * \remarks Entities are not decoded.
+ */
+inline const QString &HtmlTokenizer::title() const
+{
+    return m_title;
+}
+
+} // namespace Network
+
+#endif // NETWORK_HTMLTOKENIZER_H
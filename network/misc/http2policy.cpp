@@ -0,0 +1,73 @@
+#include "./http2policy.h"
+
+#include <QUrl>
+
+namespace Network {
+
+/*!
+ * \class Http2Policy
+ * \brief The Http2Policy class determines whether HTTP/2 is allowed for a particular host.
+ *
+ * If HTTP/2 is allowed and the server supports it (negotiated via ALPN) all requests to the host are
+ * multiplexed over a single connection by the QNetworkAccessManager instead of opening up to six HTTP/1.1
+ * connections. This is beneficial when many small transfers (e.g. audio-only streams, thumbnails or
+ * playlist pages) go to the same host. Servers not supporting HTTP/2 are served via HTTP/1.1 as usual.
+ *
+ * HTTP/2 is disabled by default. Hosts listed as exception are treated the other way around. An exception
+ * also applies to all subdomains of the listed host.
+ */
+
+/*!
+ * \brief Constructs a new policy which disables HTTP/2 for all hosts.
+ */
+Http2Policy::Http2Policy()
+    : m_enabledByDefault(false)
+{
+}
+
+/*!
+ * \brief Returns the policy used by all downloads.
+ */
+Http2Policy &Http2Policy::instance()
+{
+    static Http2Policy policy;
+    return policy;
+}
+
+/*!
+ * \brief Sets the hosts for which the default is inverted.
+ * \remarks Surrounding whitespaces and leading dots are ignored; empty entries are dropped.
+ */
+void Http2Policy::setExceptions(const QStringList &hosts)
+{
+    m_exceptions.clear();
+    m_exceptions.reserve(hosts.size());
+    for (const auto &host : hosts) {
+        auto normalizedHost = host.trimmed().toLower();
+        while (normalizedHost.startsWith(QChar('.'))) {
+            normalizedHost.remove(0, 1);
+        }
+        if (!normalizedHost.isEmpty()) {
+            m_exceptions << normalizedHost;
+        }
+    }
+}
+
+/*!
+ * \brief Returns whether HTTP/2 is allowed for requests to the specified \a url.
+ */
+bool Http2Policy::isAllowed(const QUrl &url) const
+{
+    if (m_exceptions.isEmpty()) {
+        return m_enabledByDefault;
+    }
+    const auto host = url.host().toLower();
+    for (const auto &exception : m_exceptions) {
+        if (host == exception || (host.endsWith(exception) && host.at(host.size() - exception.size() - 1) == QChar('.'))) {
+            return !m_enabledByDefault;
+        }
+    }
+    return m_enabledByDefault;
+}
+
+} // namespace Network
@@ -0,0 +1,53 @@
+#ifndef NETWORK_HTTP2POLICY_H
+#define NETWORK_HTTP2POLICY_H
+
+#include <QStringList>
+
+QT_FORWARD_DECLARE_CLASS(QUrl)
+
+namespace Network {
+
+class Http2Policy {
+public:
+    Http2Policy();
+
+    static Http2Policy &instance();
+
+    bool isEnabledByDefault() const;
+    void setEnabledByDefault(bool enabledByDefault);
+    const QStringList &exceptions() const;
+    void setExceptions(const QStringList &hosts);
+    bool isAllowed(const QUrl &url) const;
+
+private:
+    bool m_enabledByDefault;
+    QStringList m_exceptions;
+};
+
+/*!
+ * \brief Returns whether HTTP/2 is used for hosts which are not listed as exception.
+ */
+inline bool Http2Policy::isEnabledByDefault() const
+{
+    return m_enabledByDefault;
+}
+
+/*!
+ * \brief Sets whether HTTP/2 is used for hosts which are not listed as exception.
+ */
+inline void Http2Policy::setEnabledByDefault(bool enabledByDefault)
+{
+    m_enabledByDefault = enabledByDefault;
+}
+
+/*!
+ * \brief Returns the hosts for which the default is inverted.
+ */
+inline const QStringList &Http2Policy::exceptions() const
+{
+    return m_exceptions;
+}
+
+} // namespace Network
+
+#endif // NETWORK_HTTP2POLICY_H
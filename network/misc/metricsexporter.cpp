@@ -0,0 +1,202 @@
+#include "./metricsexporter.h"
+
+#include <QCoreApplication>
+#include <QHostAddress>
+#include <QPointer>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+
+#include <cmath>
+
+namespace Network {
+
+/*!
+ * \brief Specifies limits for the requests served by the MetricsExporter.
+ */
+namespace MetricsRequestLimits {
+constexpr qint64 maxSize = 8 * 1024;
+constexpr int timeout = 5000;
+} // namespace MetricsRequestLimits
+
+/*!
+ * \brief Returns the specified \a value formatted as sample value.
+ */
+static QByteArray formatValue(double value)
+{
+    return std::floor(value) == value && std::abs(value) < 1e18 ? QByteArray::number(static_cast<qint64>(value))
+                                                                 : QByteArray::number(value, 'g', 15);
+}
+
+/*!
+ * \class MetricsWriter
+ * \brief The MetricsWriter class writes metrics in the Prometheus text exposition format (which is also
+ *        accepted by OpenMetrics scrapers).
+ */
+
+/*!
+ * \brief Adds the HELP and TYPE lines for the metric with the specified \a name.
+ *
+ * Must be called before adding the samples of the metric. The \a type is "counter" or "gauge".
+ */
+void MetricsWriter::addMetric(const char *name, const char *type, const char *help)
+{
+    m_data.append("# HELP ").append(name).append(' ').append(help).append('\n');
+    m_data.append("# TYPE ").append(name).append(' ').append(type).append('\n');
+}
+
+/*!
+ * \brief Adds a sample without labels for the metric with the specified \a name.
+ */
+void MetricsWriter::addSample(const char *name, double value)
+{
+    m_data.append(name).append(' ');
+    m_data.append(formatValue(value));
+    m_data.append('\n');
+}
+
+/*!
+ * \brief Adds a sample with a single label for the metric with the specified \a name.
+ */
+void MetricsWriter::addSample(const char *name, const char *labelName, const QString &labelValue, double value)
+{
+    QByteArray escapedValue = labelValue.toUtf8();
+    escapedValue.replace('\\', "\\\\").replace('"', "\\\"").replace('\n', "\\n");
+    m_data.append(name).append('{').append(labelName).append("=\"").append(escapedValue).append("\"} ");
+    m_data.append(formatValue(value));
+    m_data.append('\n');
+}
+
+/*!
+ * \class MetricsExporter
+ * \brief The MetricsExporter class serves metrics of the running instance via HTTP on localhost.
+ *
+ * The metrics are written by the collector (see setCollector()) when they are requested via "GET /metrics".
+ * This allows monitoring instances running on headless machines with Prometheus or compatible tools.
+ *
+ * Only connections from the local machine are accepted because the server listens on the loopback
+ * interface. The server is disabled by default.
+ */
+
+/*!
+ * \brief Constructs a new, disabled exporter.
+ */
+MetricsExporter::MetricsExporter(QObject *parent)
+    : QObject(parent)
+    , m_server(new QTcpServer(this))
+    , m_enabled(false)
+    , m_port(defaultPort)
+{
+    connect(m_server, &QTcpServer::newConnection, this, &MetricsExporter::acceptConnections);
+}
+
+/*!
+ * \brief Returns the exporter used by the application.
+ * \remarks The exporter is a child of the application object so its server is closed before the application
+ *          object is destroyed. Hence this function should only be called while the application object exists.
+ */
+MetricsExporter &MetricsExporter::instance()
+{
+    static QPointer<MetricsExporter> exporter;
+    if (!exporter) {
+        exporter = new MetricsExporter(QCoreApplication::instance());
+    }
+    return *exporter;
+}
+
+/*!
+ * \brief Enables or disables serving the metrics on the specified \a port.
+ * \remarks Check isListening() and errorString() to find out whether the port could be opened.
+ */
+void MetricsExporter::setEnabled(bool enabled, quint16 port)
+{
+    if (m_enabled == enabled && m_port == port && m_server->isListening() == enabled) {
+        return;
+    }
+    m_enabled = enabled;
+    m_port = port;
+    m_server->close();
+    if (m_enabled) {
+        m_server->listen(QHostAddress::LocalHost, m_port);
+    }
+}
+
+/*!
+ * \brief Returns whether the metrics are currently served.
+ */
+bool MetricsExporter::isListening() const
+{
+    return m_server->isListening();
+}
+
+/*!
+ * \brief Returns a description of the last error which occurred when opening the port.
+ */
+QString MetricsExporter::errorString() const
+{
+    return m_server->errorString();
+}
+
+/*!
+ * \brief Returns the current metrics in the Prometheus text format.
+ */
+QByteArray MetricsExporter::collect() const
+{
+    MetricsWriter writer;
+    if (m_collector) {
+        m_collector(writer);
+    }
+    return writer.data();
+}
+
+/*!
+ * \brief Accepts pending connections.
+ */
+void MetricsExporter::acceptConnections()
+{
+    while (QTcpSocket *socket = m_server->nextPendingConnection()) {
+        connect(socket, &QTcpSocket::readyRead, this, std::bind(&MetricsExporter::handleRequest, this, socket));
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        // don't let idle clients keep the connection open
+        QTimer::singleShot(MetricsRequestLimits::timeout, socket, &QTcpSocket::abort);
+    }
+}
+
+/*!
+ * \brief Answers the request received via the specified \a socket once the request header is complete.
+ */
+void MetricsExporter::handleRequest(QTcpSocket *socket)
+{
+    if (socket->bytesAvailable() > MetricsRequestLimits::maxSize) {
+        socket->abort();
+        return;
+    }
+    const QByteArray request = socket->peek(socket->bytesAvailable());
+    if (!request.contains("\r\n\r\n") && !request.contains("\n\n")) {
+        return; // wait for the rest of the header
+    }
+    socket->readAll();
+    socket->disconnect(this);
+
+    const QList<QByteArray> requestLine = request.left(request.indexOf('\n')).trimmed().split(' ');
+    const QByteArray path = requestLine.size() >= 2 ? requestLine.at(1) : QByteArray();
+    QByteArray status, body;
+    if (requestLine.at(0) != "GET") {
+        status = "405 Method Not Allowed";
+    } else if (path == "/metrics" || path.startsWith("/metrics?")) {
+        status = "200 OK";
+        body = collect();
+    } else {
+        status = "404 Not Found";
+    }
+    QByteArray response;
+    response.append("HTTP/1.1 ").append(status).append("\r\n");
+    response.append("Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n");
+    response.append("Content-Length: ").append(QByteArray::number(body.size())).append("\r\n");
+    response.append("Connection: close\r\n\r\n");
+    response.append(body);
+    socket->write(response);
+    socket->disconnectFromHost();
+}
+
+} // namespace Network
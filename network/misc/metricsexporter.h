@@ -0,0 +1,91 @@
+#ifndef NETWORK_METRICSEXPORTER_H
+#define NETWORK_METRICSEXPORTER_H
+
+#include <QByteArray>
+#include <QObject>
+#include <QString>
+
+#include <functional>
+
+QT_FORWARD_DECLARE_CLASS(QTcpServer)
+QT_FORWARD_DECLARE_CLASS(QTcpSocket)
+
+namespace Network {
+
+class MetricsWriter {
+public:
+    void addMetric(const char *name, const char *type, const char *help);
+    void addSample(const char *name, double value);
+    void addSample(const char *name, const char *labelName, const QString &labelValue, double value);
+    const QByteArray &data() const;
+
+private:
+    QByteArray m_data;
+};
+
+/*!
+ * \brief Returns the metrics written so far in the Prometheus text format.
+ */
+inline const QByteArray &MetricsWriter::data() const
+{
+    return m_data;
+}
+
+class MetricsExporter : public QObject {
+    Q_OBJECT
+
+public:
+    using Collector = std::function<void(MetricsWriter &)>;
+    static constexpr quint16 defaultPort = 9469;
+
+    explicit MetricsExporter(QObject *parent = nullptr);
+
+    static MetricsExporter &instance();
+
+    bool isEnabled() const;
+    quint16 port() const;
+    void setEnabled(bool enabled, quint16 port);
+    bool isListening() const;
+    QString errorString() const;
+    void setCollector(const Collector &collector);
+    QByteArray collect() const;
+
+private Q_SLOTS:
+    void acceptConnections();
+
+private:
+    void handleRequest(QTcpSocket *socket);
+
+    QTcpServer *m_server;
+    Collector m_collector;
+    bool m_enabled;
+    quint16 m_port;
+};
+
+/*!
+ * \brief Returns whether the metrics should be served.
+ */
+inline bool MetricsExporter::isEnabled() const
+{
+    return m_enabled;
+}
+
+/*!
+ * \brief Returns the port the metrics are served on.
+ */
+inline quint16 MetricsExporter::port() const
+{
+    return m_port;
+}
+
+/*!
+ * \brief Sets the function which writes the metrics when they are requested.
+ */
+inline void MetricsExporter::setCollector(const Collector &collector)
+{
+    m_collector = collector;
+}
+
+} // namespace Network
+
+#endif // NETWORK_METRICSEXPORTER_H
@@ -0,0 +1,101 @@
+#include "./negativeresultcache.h"
+
+#include <QDateTime>
+
+namespace Network {
+
+/*!
+ * \class NegativeResultCache
+ * \brief The NegativeResultCache class remembers URLs and IDs which could not be initiated because of
+ *        a permanent failure.
+ *
+ * A failure is remembered for expiryTime() seconds. Downloads for the same URL or ID which are added within
+ * that time fail instantly instead of repeating the request (see Download::init()).
+ */
+
+/*!
+ * \brief Constructs a new cache which remembers failures for 30 minutes.
+ */
+NegativeResultCache::NegativeResultCache()
+    : m_expiryTime(30 * 60)
+    , m_insertionsSinceCleanup(0)
+{
+}
+
+/*!
+ * \brief Returns the cache used by all downloads.
+ */
+NegativeResultCache &NegativeResultCache::instance()
+{
+    static NegativeResultCache cache;
+    return cache;
+}
+
+/*!
+ * \brief Sets the number of seconds a failure is remembered.
+ * \remarks A value of zero or less disables the cache and drops all entries.
+ */
+void NegativeResultCache::setExpiryTime(int seconds)
+{
+    m_expiryTime = seconds;
+    if (!isEnabled()) {
+        clear();
+    }
+}
+
+/*!
+ * \brief Remembers that initiating the download with the specified \a key failed permanently.
+ * \remarks Does nothing if the cache is disabled or \a key is empty.
+ */
+void NegativeResultCache::add(const QString &key, const QString &reason, QNetworkReply::NetworkError networkError)
+{
+    if (!isEnabled() || key.isEmpty()) {
+        return;
+    }
+    const auto now = QDateTime::currentMSecsSinceEpoch();
+    // drop expired entries every now and then so the cache does not grow during long sessions
+    if (++m_insertionsSinceCleanup >= 256) {
+        removeExpiredEntries(now);
+    }
+    m_entries.insert(key, Entry{ reason, networkError, now + static_cast<qint64>(m_expiryTime) * 1000 });
+}
+
+/*!
+ * \brief Looks up the specified \a key.
+ * \returns Returns whether a non-expired failure is stored under \a key. In this case \a reason and
+ *          \a networkError are set to the values which have been passed to add().
+ */
+bool NegativeResultCache::lookup(const QString &key, QString &reason, QNetworkReply::NetworkError &networkError)
+{
+    if (m_entries.isEmpty() || key.isEmpty()) {
+        return false;
+    }
+    const auto entry = m_entries.find(key);
+    if (entry == m_entries.end()) {
+        return false;
+    }
+    if (entry->expires <= QDateTime::currentMSecsSinceEpoch()) {
+        m_entries.erase(entry);
+        return false;
+    }
+    reason = entry->reason;
+    networkError = entry->networkError;
+    return true;
+}
+
+/*!
+ * \brief Removes all entries which expired before \a now.
+ */
+void NegativeResultCache::removeExpiredEntries(qint64 now)
+{
+    for (auto i = m_entries.begin(); i != m_entries.end();) {
+        if (i->expires <= now) {
+            i = m_entries.erase(i);
+        } else {
+            ++i;
+        }
+    }
+    m_insertionsSinceCleanup = 0;
+}
+
+} // namespace Network
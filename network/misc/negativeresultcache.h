@@ -0,0 +1,98 @@
+#ifndef NETWORK_NEGATIVERESULTCACHE_H
+#define NETWORK_NEGATIVERESULTCACHE_H
+
+#include <QHash>
+#include <QNetworkReply>
+#include <QString>
+
+namespace Network {
+
+class NegativeResultCache {
+public:
+    NegativeResultCache();
+
+    static NegativeResultCache &instance();
+
+    int expiryTime() const;
+    void setExpiryTime(int seconds);
+    bool isEnabled() const;
+    int size() const;
+    void add(const QString &key, const QString &reason, QNetworkReply::NetworkError networkError = QNetworkReply::NoError);
+    bool lookup(const QString &key, QString &reason, QNetworkReply::NetworkError &networkError);
+    void remove(const QString &key);
+    void clear();
+
+    static bool isPermanentFailure(QNetworkReply::NetworkError networkError);
+
+private:
+    struct Entry {
+        QString reason;
+        QNetworkReply::NetworkError networkError;
+        qint64 expires;
+    };
+
+    void removeExpiredEntries(qint64 now);
+
+    QHash<QString, Entry> m_entries;
+    int m_expiryTime;
+    int m_insertionsSinceCleanup;
+};
+
+/*!
+ * \brief Returns the number of seconds a failure is remembered.
+ */
+inline int NegativeResultCache::expiryTime() const
+{
+    return m_expiryTime;
+}
+
+/*!
+ * \brief Returns whether failures are remembered at all.
+ */
+inline bool NegativeResultCache::isEnabled() const
+{
+    return m_expiryTime > 0;
+}
+
+/*!
+ * \brief Returns the number of entries (including expired ones which have not been removed yet).
+ */
+inline int NegativeResultCache::size() const
+{
+    return m_entries.size();
+}
+
+/*!
+ * \brief Forgets the failure stored under the specified \a key.
+ */
+inline void NegativeResultCache::remove(const QString &key)
+{
+    m_entries.remove(key);
+}
+
+/*!
+ * \brief Forgets all failures.
+ */
+inline void NegativeResultCache::clear()
+{
+    m_entries.clear();
+    m_insertionsSinceCleanup = 0;
+}
+
+/*!
+ * \brief Returns whether the specified \a networkError indicates that retrying the same URL is pointless.
+ */
+inline bool NegativeResultCache::isPermanentFailure(QNetworkReply::NetworkError networkError)
+{
+    switch (networkError) {
+    case QNetworkReply::ContentNotFoundError:
+    case QNetworkReply::ContentGoneError:
+        return true;
+    default:
+        return false;
+    }
+}
+
+} // namespace Network
+
+#endif // NETWORK_NEGATIVERESULTCACHE_H
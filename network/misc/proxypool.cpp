@@ -0,0 +1,260 @@
+#include "./proxypool.h"
+
+#include <QCoreApplication>
+#include <QPointer>
+#include <QTcpSocket>
+#include <QTimer>
+
+#include <functional>
+#include <limits>
+#include <tuple>
+
+namespace Network {
+
+/*!
+ * \class ProxyPool
+ * \brief The ProxyPool class distributes requests over multiple proxies.
+ *
+ * Each request acquires the least-loaded proxy via acquire() and hands it back via release() when finished.
+ * The index returned by acquire() is only valid for the current generation() of the proxy list so the
+ * generation needs to be stored along with the index.
+ * The load of a proxy is the number of its active connections in relation to its measured throughput so
+ * faster proxies get more requests.
+ *
+ * A proxy which fails twice in a row is ejected temporarily. When the backoff time is over, a TCP connection
+ * to the proxy is established to check whether it is available again. The backoff time is doubled each time
+ * a proxy is ejected again.
+ *
+ * If the pool is not empty it takes precedence over the proxy assigned to a particular download (see
+ * HttpDownload::startRequest()).
+ */
+
+/*!
+ * \brief Specifies parameters for ejecting failing proxies.
+ */
+namespace ProxyHealth {
+constexpr int failuresUntilEjection = 2;
+constexpr int initialBackoff = 30 * 1000;
+constexpr int maxBackoff = 10 * 60 * 1000;
+constexpr int probeTimeout = 10 * 1000;
+constexpr double throughputSmoothingFactor = 0.3;
+} // namespace ProxyHealth
+
+/*!
+ * \brief Constructs an empty pool.
+ */
+ProxyPool::ProxyPool(QObject *parent)
+    : QObject(parent)
+    , m_generation(0)
+{
+}
+
+/*!
+ * \brief Returns the pool used by all downloads.
+ * \remarks The pool is a child of the application object so its timers and sockets are destroyed before the
+ *          application object. Hence this function should only be called while the application object exists.
+ */
+ProxyPool &ProxyPool::instance()
+{
+    static QPointer<ProxyPool> pool;
+    if (!pool) {
+        pool = new ProxyPool(QCoreApplication::instance());
+    }
+    return *pool;
+}
+
+/*!
+ * \brief Returns the proxies.
+ */
+QList<QNetworkProxy> ProxyPool::proxies() const
+{
+    QList<QNetworkProxy> proxies;
+    proxies.reserve(size());
+    for (const auto &entry : m_entries) {
+        proxies << entry.proxy;
+    }
+    return proxies;
+}
+
+/*!
+ * \brief Replaces the proxies.
+ * \remarks The statistics of all proxies are reset. Requests which are still using a proxy of the previous
+ *          list will not be accounted because their generation is outdated.
+ */
+void ProxyPool::setProxies(const QList<QNetworkProxy> &proxies)
+{
+    ++m_generation;
+    m_entries.clear();
+    m_entries.reserve(static_cast<std::size_t>(proxies.size()));
+    for (const auto &proxy : proxies) {
+        if (proxy.type() != QNetworkProxy::NoProxy && !proxy.hostName().isEmpty()) {
+            m_entries.emplace_back(Entry{ proxy, 0, 0.0, 0, 0, false });
+        }
+    }
+}
+
+/*!
+ * \brief Returns the index of the least-loaded proxy and increases its connection count.
+ *
+ * Proxies with an index contained by \a avoidedIndices (eg. the ones which have already failed for a request
+ * which is retried) are only used if all other proxies are avoided as well. Among these, ejected proxies are
+ * only used if all of them are ejected.
+ *
+ * \returns Returns -1 if the pool is empty. Otherwise a proxy is returned in any case.
+ */
+int ProxyPool::acquire(const QList<int> &avoidedIndices)
+{
+    if (m_entries.empty()) {
+        return -1;
+    }
+    // use the average throughput for proxies which have not been measured yet
+    double averageThroughput = 0.0;
+    int measuredProxies = 0;
+    for (const auto &entry : m_entries) {
+        if (entry.throughput > 0.0) {
+            averageThroughput += entry.throughput;
+            ++measuredProxies;
+        }
+    }
+    averageThroughput = measuredProxies ? averageThroughput / measuredProxies : 1.0;
+
+    int bestIndex = -1;
+    bool bestAvoided = true, bestEjected = true;
+    double bestLoad = std::numeric_limits<double>::max();
+    for (std::size_t index = 0; index != m_entries.size(); ++index) {
+        const auto &entry = m_entries[index];
+        const auto avoided = avoidedIndices.contains(static_cast<int>(index));
+        const auto load = (entry.activeConnections + 1) / (entry.throughput > 0.0 ? entry.throughput : averageThroughput);
+        if (bestIndex < 0 || std::tie(avoided, entry.ejected, load) < std::tie(bestAvoided, bestEjected, bestLoad)) {
+            bestIndex = static_cast<int>(index);
+            bestAvoided = avoided;
+            bestEjected = entry.ejected;
+            bestLoad = load;
+        }
+    }
+    ++m_entries[static_cast<std::size_t>(bestIndex)].activeConnections;
+    return bestIndex;
+}
+
+/*!
+ * \brief Decreases the connection count of the proxy with the specified \a index and accounts the transferred data.
+ * \param generation Specifies the generation() the \a index has been acquired from; outdated indices are ignored.
+ * \param bytesReceived Specifies the number of bytes received via the proxy.
+ * \param milliseconds Specifies the duration of the transfer.
+ */
+void ProxyPool::release(int index, unsigned int generation, qint64 bytesReceived, qint64 milliseconds)
+{
+    if (!isCurrent(index, generation)) {
+        return;
+    }
+    auto &entry = m_entries[static_cast<std::size_t>(index)];
+    if (entry.activeConnections > 0) {
+        --entry.activeConnections;
+    }
+    // ignore short transfers because they don't tell much about the throughput
+    if (bytesReceived > 0 && milliseconds >= 500) {
+        const auto throughput = bytesReceived * 1000.0 / milliseconds;
+        entry.throughput = entry.throughput > 0.0
+            ? entry.throughput + ProxyHealth::throughputSmoothingFactor * (throughput - entry.throughput)
+            : throughput;
+    }
+}
+
+/*!
+ * \brief Reports that a request via the proxy with the specified \a index succeeded.
+ * \remarks Outdated indices (see generation()) are ignored.
+ */
+void ProxyPool::reportSuccess(int index, unsigned int generation)
+{
+    if (isCurrent(index, generation)) {
+        m_entries[static_cast<std::size_t>(index)].consecutiveFailures = 0;
+    }
+}
+
+/*!
+ * \brief Reports that a request via the proxy with the specified \a index failed because of the proxy.
+ *
+ * The proxy is ejected temporarily if it failed multiple times in a row. Outdated indices (see generation())
+ * are ignored.
+ */
+void ProxyPool::reportFailure(int index, unsigned int generation)
+{
+    if (!isCurrent(index, generation)) {
+        return;
+    }
+    auto &entry = m_entries[static_cast<std::size_t>(index)];
+    if (!entry.ejected && ++entry.consecutiveFailures >= ProxyHealth::failuresUntilEjection) {
+        eject(index);
+    }
+}
+
+/*!
+ * \brief Returns whether the specified \a networkError is caused by the proxy.
+ */
+bool ProxyPool::isProxyError(QNetworkReply::NetworkError networkError)
+{
+    switch (networkError) {
+    case QNetworkReply::ProxyConnectionRefusedError:
+    case QNetworkReply::ProxyConnectionClosedError:
+    case QNetworkReply::ProxyNotFoundError:
+    case QNetworkReply::ProxyTimeoutError:
+    case QNetworkReply::UnknownProxyError:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/*!
+ * \brief Ejects the proxy with the specified \a index and schedules a health check.
+ */
+void ProxyPool::eject(int index)
+{
+    auto &entry = m_entries[static_cast<std::size_t>(index)];
+    entry.ejected = true;
+    const auto backoff = qMin(ProxyHealth::initialBackoff << qMin(entry.ejections, 5), ProxyHealth::maxBackoff);
+    ++entry.ejections;
+    emit proxyEjected(index);
+    const auto generation = m_generation;
+    QTimer::singleShot(backoff, this, [this, index, generation] { checkHealth(index, generation); });
+}
+
+/*!
+ * \brief Checks whether the proxy with the specified \a index is reachable again.
+ * \remarks Does nothing if the proxies have been replaced since the check has been scheduled.
+ */
+void ProxyPool::checkHealth(int index, unsigned int generation)
+{
+    if (generation != m_generation) {
+        return;
+    }
+    const auto &proxy = m_entries[static_cast<std::size_t>(index)].proxy;
+    auto *const socket = new QTcpSocket(this);
+    socket->setProxy(QNetworkProxy::NoProxy);
+    const auto handleResult = [this, socket, index, generation](bool reachable) {
+        socket->disconnect(this);
+        socket->abort();
+        socket->deleteLater();
+        if (generation != m_generation) {
+            return;
+        }
+        if (!reachable) {
+            eject(index);
+            return;
+        }
+        auto &entry = m_entries[static_cast<std::size_t>(index)];
+        entry.ejected = false;
+        entry.consecutiveFailures = 0;
+        emit proxyRecovered(index);
+    };
+    connect(socket, &QTcpSocket::connected, this, std::bind(handleResult, true));
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+    connect(socket, &QTcpSocket::errorOccurred, this, std::bind(handleResult, false));
+#else
+    connect(socket, static_cast<void (QTcpSocket::*)(QAbstractSocket::SocketError)>(&QTcpSocket::error), this, std::bind(handleResult, false));
+#endif
+    QTimer::singleShot(ProxyHealth::probeTimeout, socket, std::bind(handleResult, false));
+    socket->connectToHost(proxy.hostName(), proxy.port());
+}
+
+} // namespace Network
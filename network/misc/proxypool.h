@@ -0,0 +1,128 @@
+#ifndef NETWORK_PROXYPOOL_H
+#define NETWORK_PROXYPOOL_H
+
+#include <QList>
+#include <QNetworkProxy>
+#include <QNetworkReply>
+#include <QObject>
+
+#include <vector>
+
+namespace Network {
+
+class ProxyPool : public QObject {
+    Q_OBJECT
+
+public:
+    explicit ProxyPool(QObject *parent = nullptr);
+
+    static ProxyPool &instance();
+
+    QList<QNetworkProxy> proxies() const;
+    void setProxies(const QList<QNetworkProxy> &proxies);
+    bool isEmpty() const;
+    int size() const;
+    const QNetworkProxy &proxy(int index) const;
+    int activeConnections(int index) const;
+    double throughput(int index) const;
+    bool isEjected(int index) const;
+    unsigned int generation() const;
+
+    int acquire(const QList<int> &avoidedIndices = QList<int>());
+    void release(int index, unsigned int generation, qint64 bytesReceived, qint64 milliseconds);
+    void reportSuccess(int index, unsigned int generation);
+    void reportFailure(int index, unsigned int generation);
+
+    static bool isProxyError(QNetworkReply::NetworkError networkError);
+
+Q_SIGNALS:
+    void proxyEjected(int index);
+    void proxyRecovered(int index);
+
+private:
+    struct Entry {
+        QNetworkProxy proxy;
+        int activeConnections;
+        double throughput;
+        int consecutiveFailures;
+        int ejections;
+        bool ejected;
+    };
+
+    bool isCurrent(int index, unsigned int generation) const;
+    void eject(int index);
+    void checkHealth(int index, unsigned int generation);
+
+    std::vector<Entry> m_entries;
+    unsigned int m_generation;
+};
+
+/*!
+ * \brief Returns whether the pool contains no proxies.
+ */
+inline bool ProxyPool::isEmpty() const
+{
+    return m_entries.empty();
+}
+
+/*!
+ * \brief Returns the number of proxies.
+ */
+inline int ProxyPool::size() const
+{
+    return static_cast<int>(m_entries.size());
+}
+
+/*!
+ * \brief Returns the proxy with the specified \a index.
+ */
+inline const QNetworkProxy &ProxyPool::proxy(int index) const
+{
+    return m_entries.at(static_cast<std::size_t>(index)).proxy;
+}
+
+/*!
+ * \brief Returns the number of requests currently using the proxy with the specified \a index.
+ */
+inline int ProxyPool::activeConnections(int index) const
+{
+    return m_entries.at(static_cast<std::size_t>(index)).activeConnections;
+}
+
+/*!
+ * \brief Returns the average throughput of the proxy with the specified \a index in byte per second.
+ * \remarks Returns zero if no request has been finished via that proxy so far.
+ */
+inline double ProxyPool::throughput(int index) const
+{
+    return m_entries.at(static_cast<std::size_t>(index)).throughput;
+}
+
+/*!
+ * \brief Returns whether the proxy with the specified \a index is currently not used because it failed.
+ */
+inline bool ProxyPool::isEjected(int index) const
+{
+    return m_entries.at(static_cast<std::size_t>(index)).ejected;
+}
+
+/*!
+ * \brief Returns the generation of the proxy list which is incremented each time the proxies are replaced.
+ * \remarks Must be passed to release(), reportSuccess() and reportFailure() along with the index returned by acquire().
+ */
+inline unsigned int ProxyPool::generation() const
+{
+    return m_generation;
+}
+
+/*!
+ * \brief Returns whether the specified \a index refers to a proxy of the current list.
+ */
+inline bool ProxyPool::isCurrent(int index, unsigned int generation) const
+{
+    return generation == m_generation && index >= 0 && index < size();
+}
+
+} // namespace Network
+
+#endif // NETWORK_PROXYPOOL_H
@@ -0,0 +1,93 @@
+#include "./rateestimator.h"
+
+#include <cmath>
+
+namespace Network {
+
+/*!
+ * \class RateEstimator
+ * \brief The RateEstimator class estimates a transfer rate from samples of transferred bytes.
+ *
+ * Two estimations are provided: an exponentially weighted moving average with a configurable half-life
+ * (see rate()) and the average over a fixed number of recent samples (see windowRate()). Since samples
+ * might arrive in irregular intervals the weight of a sample depends on the time it covers. Adding a
+ * sample and querying the rates are O(1) operations.
+ */
+
+int RateEstimator::s_defaultHalfLife = 3000;
+
+/*!
+ * \brief Constructs a new estimator using the defaultHalfLife().
+ */
+RateEstimator::RateEstimator()
+    : m_samples()
+    , m_nextSample(0)
+    , m_sampleCount(0)
+    , m_windowBytes(0)
+    , m_windowMilliseconds(0)
+    , m_rate(0.0)
+    , m_halfLife(s_defaultHalfLife)
+{
+}
+
+/*!
+ * \brief Sets the half-life used by new estimators in milliseconds.
+ *
+ * A sample covering the specified time gets the same weight as all previous samples.
+ *
+ * \remarks Values smaller than one are ignored.
+ */
+void RateEstimator::setDefaultHalfLife(int milliseconds)
+{
+    if (milliseconds > 0) {
+        s_defaultHalfLife = milliseconds;
+    }
+}
+
+/*!
+ * \brief Adds a sample of \a bytes which have been transferred within the specified number of \a milliseconds.
+ * \remarks Samples covering no time are ignored.
+ */
+void RateEstimator::addSample(qint64 bytes, qint64 milliseconds)
+{
+    if (milliseconds <= 0) {
+        return;
+    }
+
+    // update sliding window
+    auto &sample = m_samples[m_nextSample];
+    if (m_sampleCount == windowSize) {
+        m_windowBytes -= sample.bytes;
+        m_windowMilliseconds -= sample.milliseconds;
+    } else {
+        ++m_sampleCount;
+    }
+    sample.bytes = bytes;
+    sample.milliseconds = milliseconds;
+    m_windowBytes += bytes;
+    m_windowMilliseconds += milliseconds;
+    m_nextSample = (m_nextSample + 1) % windowSize;
+
+    // update moving average; the first sample is taken as it is
+    const auto sampleRate = static_cast<double>(bytes) * 1000.0 / static_cast<double>(milliseconds);
+    if (m_sampleCount == 1) {
+        m_rate = sampleRate;
+    } else {
+        const auto alpha = 1.0 - std::exp2(-static_cast<double>(milliseconds) / static_cast<double>(m_halfLife));
+        m_rate += alpha * (sampleRate - m_rate);
+    }
+}
+
+/*!
+ * \brief Drops all samples.
+ */
+void RateEstimator::reset()
+{
+    m_nextSample = 0;
+    m_sampleCount = 0;
+    m_windowBytes = 0;
+    m_windowMilliseconds = 0;
+    m_rate = 0.0;
+}
+
+} // namespace Network
@@ -0,0 +1,84 @@
+#ifndef NETWORK_RATEESTIMATOR_H
+#define NETWORK_RATEESTIMATOR_H
+
+#include <QtGlobal>
+
+#include <array>
+
+namespace Network {
+
+class RateEstimator {
+public:
+    static constexpr std::size_t windowSize = 16;
+
+    RateEstimator();
+
+    static int defaultHalfLife();
+    static void setDefaultHalfLife(int milliseconds);
+
+    int halfLife() const;
+    void addSample(qint64 bytes, qint64 milliseconds);
+    double rate() const;
+    double windowRate() const;
+    bool hasRate() const;
+    void reset();
+
+private:
+    struct Sample {
+        qint64 bytes;
+        qint64 milliseconds;
+    };
+
+    static int s_defaultHalfLife;
+    std::array<Sample, windowSize> m_samples;
+    std::size_t m_nextSample;
+    std::size_t m_sampleCount;
+    qint64 m_windowBytes;
+    qint64 m_windowMilliseconds;
+    double m_rate;
+    int m_halfLife;
+};
+
+/*!
+ * \brief Returns the half-life used by new estimators in milliseconds.
+ */
+inline int RateEstimator::defaultHalfLife()
+{
+    return s_defaultHalfLife;
+}
+
+/*!
+ * \brief Returns the half-life of the exponentially weighted moving average in milliseconds.
+ */
+inline int RateEstimator::halfLife() const
+{
+    return m_halfLife;
+}
+
+/*!
+ * \brief Returns the exponentially weighted moving average of the rate in byte per second.
+ */
+inline double RateEstimator::rate() const
+{
+    return m_rate;
+}
+
+/*!
+ * \brief Returns the average rate over the last windowSize samples in byte per second.
+ */
+inline double RateEstimator::windowRate() const
+{
+    return m_windowMilliseconds > 0 ? static_cast<double>(m_windowBytes) * 1000.0 / static_cast<double>(m_windowMilliseconds) : 0.0;
+}
+
+/*!
+ * \brief Returns whether at least one sample has been added.
+ */
+inline bool RateEstimator::hasRate() const
+{
+    return m_sampleCount > 0;
+}
+
+} // namespace Network
+
+#endif // NETWORK_RATEESTIMATOR_H
@@ -0,0 +1,202 @@
+#include "./sslsessioncache.h"
+
+#include <QDateTime>
+#include <QMutexLocker>
+#include <QUrl>
+#include <QVariantList>
+
+namespace Network {
+
+/*!
+ * \class SslSessionCache
+ * \brief The SslSessionCache class stores TLS session tickets per host so further connections to the same host
+ *        can resume the session instead of doing a full handshake.
+ *
+ * Tickets are obtained from the QSslConfiguration of finished replies and applied to new requests by
+ * HttpDownload::startRequest(). The cache is thread-safe so it can be shared between multiple network
+ * access managers. It can be persisted using toVariantMap() and restoreFromVariantMap().
+ */
+
+/*!
+ * \brief Tickets without lifetime hint are considered valid for this number of seconds.
+ */
+constexpr qint64 defaultTicketLifeTime = 60 * 60;
+
+/*!
+ * \brief Constructs an empty cache.
+ */
+SslSessionCache::SslSessionCache()
+    : m_maxEntries(256)
+{
+}
+
+/*!
+ * \brief Returns the cache used by all downloads.
+ */
+SslSessionCache &SslSessionCache::instance()
+{
+    static SslSessionCache cache;
+    return cache;
+}
+
+/*!
+ * \brief Returns the key used to store the session for the specified \a url.
+ * \remarks Returns an empty string if \a url does not use TLS.
+ */
+QString SslSessionCache::keyForUrl(const QUrl &url)
+{
+    if (url.scheme().compare(QLatin1String("https"), Qt::CaseInsensitive)) {
+        return QString();
+    }
+    return url.host().toLower() + QChar(':') + QString::number(url.port(443));
+}
+
+/*!
+ * \brief Returns the session ticket stored for \a key or an empty byte array if there is no valid one.
+ */
+QByteArray SslSessionCache::sessionTicket(const QString &key)
+{
+    QMutexLocker locker(&m_mutex);
+    const auto entry = m_entries.find(key);
+    if (entry == m_entries.end()) {
+        return QByteArray();
+    }
+    if (entry->expires <= QDateTime::currentMSecsSinceEpoch()) {
+        m_entries.erase(entry);
+        return QByteArray();
+    }
+    return entry->ticket;
+}
+
+/*!
+ * \brief Stores the specified session \a ticket for \a key.
+ * \param lifeTimeHint Specifies the lifetime of the ticket in seconds as announced by the server; a
+ *                     negative value means the lifetime is unknown.
+ */
+void SslSessionCache::storeSessionTicket(const QString &key, const QByteArray &ticket, int lifeTimeHint)
+{
+    if (key.isEmpty() || ticket.isEmpty() || !m_maxEntries) {
+        return;
+    }
+    const auto now = QDateTime::currentMSecsSinceEpoch();
+    const auto lifeTime = lifeTimeHint > 0 ? static_cast<qint64>(lifeTimeHint) : defaultTicketLifeTime;
+    QMutexLocker locker(&m_mutex);
+    if (m_entries.size() >= m_maxEntries && !m_entries.contains(key)) {
+        removeExpiredEntries(now);
+        // still full: drop the entry which expires first
+        if (m_entries.size() >= m_maxEntries) {
+            auto first = m_entries.begin();
+            for (auto i = m_entries.begin(), end = m_entries.end(); i != end; ++i) {
+                if (i->expires < first->expires) {
+                    first = i;
+                }
+            }
+            m_entries.erase(first);
+        }
+    }
+    m_entries.insert(key, Entry{ ticket, now + lifeTime * 1000 });
+}
+
+/*!
+ * \brief Removes the session ticket stored for \a key.
+ *
+ * Should be called when resuming the session failed.
+ */
+void SslSessionCache::remove(const QString &key)
+{
+    QMutexLocker locker(&m_mutex);
+    m_entries.remove(key);
+}
+
+/*!
+ * \brief Removes all session tickets.
+ */
+void SslSessionCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_entries.clear();
+}
+
+/*!
+ * \brief Returns the number of stored session tickets (including expired ones which have not been removed yet).
+ */
+int SslSessionCache::size() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_entries.size();
+}
+
+/*!
+ * \brief Returns the max. number of hosts to store session tickets for.
+ */
+int SslSessionCache::maxEntries() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_maxEntries;
+}
+
+/*!
+ * \brief Sets the max. number of hosts to store session tickets for.
+ * \remarks Zero disables the cache.
+ */
+void SslSessionCache::setMaxEntries(int maxEntries)
+{
+    QMutexLocker locker(&m_mutex);
+    m_maxEntries = maxEntries > 0 ? maxEntries : 0;
+    if (!m_maxEntries) {
+        m_entries.clear();
+    }
+}
+
+/*!
+ * \brief Returns the non-expired session tickets as variant map which can be stored using QSettings.
+ */
+QVariantMap SslSessionCache::toVariantMap() const
+{
+    const auto now = QDateTime::currentMSecsSinceEpoch();
+    QVariantMap map;
+    QMutexLocker locker(&m_mutex);
+    for (auto i = m_entries.cbegin(), end = m_entries.cend(); i != end; ++i) {
+        if (i->expires > now) {
+            map.insert(i.key(), QVariantList{ i->ticket, i->expires });
+        }
+    }
+    return map;
+}
+
+/*!
+ * \brief Restores the session tickets from the specified \a map (previously created using toVariantMap()).
+ */
+void SslSessionCache::restoreFromVariantMap(const QVariantMap &map)
+{
+    const auto now = QDateTime::currentMSecsSinceEpoch();
+    QMutexLocker locker(&m_mutex);
+    for (auto i = map.cbegin(), end = map.cend(); i != end && m_entries.size() < m_maxEntries; ++i) {
+        const auto values = i.value().toList();
+        if (values.size() != 2) {
+            continue;
+        }
+        const auto ticket = values.at(0).toByteArray();
+        const auto expires = values.at(1).toLongLong();
+        if (!ticket.isEmpty() && expires > now) {
+            m_entries.insert(i.key(), Entry{ ticket, expires });
+        }
+    }
+}
+
+/*!
+ * \brief Removes all entries which expired before \a now.
+ * \remarks The mutex must be locked by the caller.
+ */
+void SslSessionCache::removeExpiredEntries(qint64 now)
+{
+    for (auto i = m_entries.begin(); i != m_entries.end();) {
+        if (i->expires <= now) {
+            i = m_entries.erase(i);
+        } else {
+            ++i;
+        }
+    }
+}
+
+} // namespace Network
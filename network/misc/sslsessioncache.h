@@ -0,0 +1,47 @@
+#ifndef NETWORK_SSLSESSIONCACHE_H
+#define NETWORK_SSLSESSIONCACHE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QVariantMap>
+
+QT_FORWARD_DECLARE_CLASS(QUrl)
+
+namespace Network {
+
+class SslSessionCache {
+public:
+    SslSessionCache();
+
+    static SslSessionCache &instance();
+    static QString keyForUrl(const QUrl &url);
+
+    QByteArray sessionTicket(const QString &key);
+    void storeSessionTicket(const QString &key, const QByteArray &ticket, int lifeTimeHint = -1);
+    void remove(const QString &key);
+    void clear();
+    int size() const;
+    int maxEntries() const;
+    void setMaxEntries(int maxEntries);
+
+    QVariantMap toVariantMap() const;
+    void restoreFromVariantMap(const QVariantMap &map);
+
+private:
+    struct Entry {
+        QByteArray ticket;
+        qint64 expires;
+    };
+
+    void removeExpiredEntries(qint64 now);
+
+    mutable QMutex m_mutex;
+    QHash<QString, Entry> m_entries;
+    int m_maxEntries;
+};
+
+} // namespace Network
+
+#endif // NETWORK_SSLSESSIONCACHE_H
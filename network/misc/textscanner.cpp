@@ -0,0 +1,89 @@
+#include "./textscanner.h"
+
+namespace Network {
+
+/*!
+ * \class TextScanner
+ * \brief The TextScanner class extracts values between markers from a text (usually a web page) in a single pass.
+ *
+ * The markers are passed as QStringMatcher so the tables used to search for them are only computed once (extractors
+ * usually keep them in static variables). The scanner holds a cursor which is only advanced when a value has been found.
+ * Hence the page is not searched from the beginning again for each value as long as the values are extracted in the order
+ * they appear on the page.
+ */
+
+/*!
+ * \brief Constructs a new scanner for the specified \a text; the cursor is at the beginning.
+ * \remarks The \a text must outlive the scanner.
+ */
+TextScanner::TextScanner(const QString &text)
+    : m_text(text)
+    , m_position(0)
+{
+}
+
+/*!
+ * \brief Moves the cursor to the next occurrence of the specified \a marker.
+ * \returns Returns whether the \a marker has been found; otherwise the cursor is not moved.
+ */
+bool TextScanner::skipTo(const QStringMatcher &marker)
+{
+    const auto index = find(marker);
+    if (index < 0) {
+        return false;
+    }
+    m_position = index;
+    return true;
+}
+
+/*!
+ * \brief Moves the cursor behind the next occurrence of the specified \a marker.
+ * \returns Returns whether the \a marker has been found; otherwise the cursor is not moved.
+ */
+bool TextScanner::skipPast(const QStringMatcher &marker)
+{
+    const auto index = find(marker);
+    if (index < 0) {
+        return false;
+    }
+    m_position = index + marker.pattern().size();
+    return true;
+}
+
+/*!
+ * \brief Assigns the text between the cursor and the next occurrence of the specified \a endMarker to \a target.
+ *
+ * The cursor is moved behind the \a endMarker.
+ *
+ * \returns Returns whether the \a endMarker has been found; otherwise neither the cursor nor \a target are altered.
+ */
+bool TextScanner::readUntil(const QStringMatcher &endMarker, QString &target)
+{
+    const auto end = find(endMarker);
+    if (end < 0) {
+        return false;
+    }
+    target = m_text.mid(m_position, end - m_position);
+    m_position = end + endMarker.pattern().size();
+    return true;
+}
+
+/*!
+ * \brief Assigns the text between the next occurrence of the specified \a startMarker and the following occurrence
+ *        of the specified \a endMarker to \a target.
+ *
+ * The cursor is moved behind the \a endMarker.
+ *
+ * \returns Returns whether both markers have been found; otherwise neither the cursor nor \a target are altered.
+ */
+bool TextScanner::extract(const QStringMatcher &startMarker, const QStringMatcher &endMarker, QString &target)
+{
+    const auto position = m_position;
+    if (skipPast(startMarker) && readUntil(endMarker, target)) {
+        return true;
+    }
+    m_position = position;
+    return false;
+}
+
+} // namespace Network
@@ -0,0 +1,64 @@
+#ifndef NETWORK_TEXTSCANNER_H
+#define NETWORK_TEXTSCANNER_H
+
+#include <QString>
+#include <QStringMatcher>
+
+namespace Network {
+
+class TextScanner {
+public:
+    explicit TextScanner(const QString &text);
+
+    const QString &text() const;
+    int position() const;
+    void setPosition(int position);
+
+    int find(const QStringMatcher &marker) const;
+    bool skipTo(const QStringMatcher &marker);
+    bool skipPast(const QStringMatcher &marker);
+    bool readUntil(const QStringMatcher &endMarker, QString &target);
+    bool extract(const QStringMatcher &startMarker, const QStringMatcher &endMarker, QString &target);
+
+private:
+    const QString &m_text;
+    int m_position;
+};
+
+/*!
+ * \brief Returns the scanned text.
+ */
+inline const QString &TextScanner::text() const
+{
+    return m_text;
+}
+
+/*!
+ * \brief Returns the current position of the cursor.
+ */
+inline int TextScanner::position() const
+{
+    return m_position;
+}
+
+/*!
+ * \brief Moves the cursor to the specified \a position.
+ * \remarks Only required when a value might occur before the current position.
+ */
+inline void TextScanner::setPosition(int position)
+{
+    m_position = position;
+}
+
+/*!
+ * \brief Returns the index of the next occurrence of the specified \a marker or -1 if there is none.
+ * \remarks The cursor is not moved.
+ */
+inline int TextScanner::find(const QStringMatcher &marker) const
+{
+    return marker.indexIn(m_text, m_position);
+}
+
+} // namespace Network
+
+#endif // NETWORK_TEXTSCANNER_H
@@ -0,0 +1,142 @@
+#include "./transfertimings.h"
+
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QStringList>
+
+namespace Network {
+
+/*!
+ * \class TransferTimings
+ * \brief The TransferTimings class holds the timestamps of the phases of a single transfer.
+ *
+ * The timestamps are recorded by the download implementation (see Download::reportTransferPhase()) and allow
+ * to tell whether a slow download is slow because of the connection setup, the server or the throughput.
+ *
+ * QNetworkAccessManager does not expose the host lookup separately so it is accounted to the connection
+ * setup. If a connection is reused the connection phases are not reached at all.
+ */
+
+/*!
+ * \brief Constructs empty timings.
+ */
+TransferTimings::TransferTimings()
+    : m_timestamps()
+{
+}
+
+/*!
+ * \brief Records that the specified \a phase has been reached at the specified \a timestamp (milliseconds since epoch).
+ * \remarks Only the first timestamp of a phase is kept.
+ */
+void TransferTimings::record(Phase phase, qint64 timestamp)
+{
+    auto &recorded = m_timestamps[static_cast<std::size_t>(phase)];
+    if (!recorded) {
+        recorded = timestamp;
+    }
+}
+
+/*!
+ * \brief Records that a redirection has been followed at the specified \a timestamp (milliseconds since epoch).
+ */
+void TransferTimings::recordRedirect(qint64 timestamp)
+{
+    m_redirects << timestamp;
+}
+
+/*!
+ * \brief Returns the number of milliseconds between the specified phases or -1 if one of the phases has not been reached.
+ */
+qint64 TransferTimings::duration(Phase from, Phase to) const
+{
+    const auto start = timestamp(from), end = timestamp(to);
+    return start && end ? end - start : -1;
+}
+
+/*!
+ * \brief Clears all recorded timestamps.
+ */
+void TransferTimings::clear()
+{
+    m_timestamps.fill(0);
+    m_redirects.clear();
+}
+
+/*!
+ * \brief Returns a human-readable breakdown of the durations of the phases reached so far.
+ */
+QString TransferTimings::toString() const
+{
+    if (isEmpty()) {
+        return QString();
+    }
+    QStringList lines;
+    const auto addLine = [&lines](const char *label, qint64 duration) {
+        if (duration >= 0) {
+            lines << QCoreApplication::translate("Network::TransferTimings", label) + QStringLiteral(": %1 ms").arg(duration);
+        }
+    };
+    const auto connected = timestamp(Phase::Encrypted) ? Phase::Encrypted : Phase::RequestSent;
+    const auto waitingSince = timestamp(Phase::RequestSent) ? Phase::RequestSent : Phase::RequestIssued;
+    addLine(QT_TRANSLATE_NOOP("Network::TransferTimings", "Queued"), duration(Phase::RequestIssued, Phase::ConnectingStarted));
+    addLine(connected == Phase::Encrypted ? QT_TRANSLATE_NOOP("Network::TransferTimings", "Host lookup, connect and TLS handshake")
+                                          : QT_TRANSLATE_NOOP("Network::TransferTimings", "Host lookup and connect"),
+        duration(Phase::ConnectingStarted, connected));
+    addLine(QT_TRANSLATE_NOOP("Network::TransferTimings", "Time to first byte"), duration(waitingSince, Phase::FirstByte));
+    addLine(QT_TRANSLATE_NOOP("Network::TransferTimings", "Body"), duration(Phase::FirstByte, Phase::Finished));
+    addLine(QT_TRANSLATE_NOOP("Network::TransferTimings", "Total"), duration(Phase::RequestIssued, Phase::Finished));
+    if (!m_redirects.isEmpty()) {
+        lines << QCoreApplication::translate("Network::TransferTimings", "Redirections: %1").arg(m_redirects.size());
+    }
+    return lines.join(QChar('\n'));
+}
+
+/*!
+ * \brief Returns the timestamps as JSON object.
+ *
+ * Each reached phase is stored under its phaseName() as milliseconds since epoch. The timestamps of
+ * followed redirections are stored as array under "redirects".
+ */
+QJsonObject TransferTimings::toJson() const
+{
+    QJsonObject object;
+    for (std::size_t i = 0; i != phaseCount; ++i) {
+        if (m_timestamps[i]) {
+            object.insert(QString::fromLatin1(phaseName(static_cast<Phase>(i))), m_timestamps[i]);
+        }
+    }
+    if (!m_redirects.isEmpty()) {
+        QJsonArray redirects;
+        for (const auto redirect : m_redirects) {
+            redirects.append(redirect);
+        }
+        object.insert(QStringLiteral("redirects"), redirects);
+    }
+    return object;
+}
+
+/*!
+ * \brief Returns the name of the specified \a phase as used by toJson().
+ */
+const char *TransferTimings::phaseName(Phase phase)
+{
+    switch (phase) {
+    case Phase::RequestIssued:
+        return "requestIssued";
+    case Phase::ConnectingStarted:
+        return "connectingStarted";
+    case Phase::Encrypted:
+        return "encrypted";
+    case Phase::RequestSent:
+        return "requestSent";
+    case Phase::FirstByte:
+        return "firstByte";
+    case Phase::Finished:
+        return "finished";
+    }
+    return "";
+}
+
+} // namespace Network
@@ -0,0 +1,73 @@
+#ifndef NETWORK_TRANSFERTIMINGS_H
+#define NETWORK_TRANSFERTIMINGS_H
+
+#include <QList>
+#include <QString>
+
+#include <array>
+
+QT_FORWARD_DECLARE_CLASS(QJsonObject)
+
+namespace Network {
+
+class TransferTimings {
+public:
+    /*!
+     * \brief Specifies the phases of a transfer a timestamp is recorded for.
+     */
+    enum class Phase {
+        RequestIssued, /**< The request has been passed to the network access manager. */
+        ConnectingStarted, /**< The socket started connecting (includes the host lookup; requires Qt 6.3). */
+        Encrypted, /**< The TLS handshake has been completed. */
+        RequestSent, /**< The request has been sent to the server (requires Qt 6.3). */
+        FirstByte, /**< The first byte of the response body has been received. */
+        Finished /**< The transfer has been finished (successfully or not). */
+    };
+    static constexpr std::size_t phaseCount = static_cast<std::size_t>(Phase::Finished) + 1;
+
+    TransferTimings();
+
+    void record(Phase phase, qint64 timestamp);
+    void recordRedirect(qint64 timestamp);
+    qint64 timestamp(Phase phase) const;
+    qint64 duration(Phase from, Phase to) const;
+    const QList<qint64> &redirects() const;
+    bool isEmpty() const;
+    void clear();
+    QString toString() const;
+    QJsonObject toJson() const;
+    static const char *phaseName(Phase phase);
+
+private:
+    std::array<qint64, phaseCount> m_timestamps;
+    QList<qint64> m_redirects;
+};
+
+/*!
+ * \brief Returns the timestamp (milliseconds since epoch) the specified \a phase has been reached or zero
+ *        if it has not been reached (or could not be determined).
+ */
+inline qint64 TransferTimings::timestamp(Phase phase) const
+{
+    return m_timestamps[static_cast<std::size_t>(phase)];
+}
+
+/*!
+ * \brief Returns the timestamps (milliseconds since epoch) of the redirections which have been followed.
+ */
+inline const QList<qint64> &TransferTimings::redirects() const
+{
+    return m_redirects;
+}
+
+/*!
+ * \brief Returns whether no request has been issued yet.
+ */
+inline bool TransferTimings::isEmpty() const
+{
+    return !timestamp(Phase::RequestIssued);
+}
+
+} // namespace Network
+
+#endif // NETWORK_TRANSFERTIMINGS_H
@@ -0,0 +1,92 @@
+#include "./urlencodedformreader.h"
+
+namespace Network {
+
+/*!
+ * \class UrlEncodedFormReader
+ * \brief The UrlEncodedFormReader class tokenizes "application/x-www-form-urlencoded" data.
+ *
+ * The fields are returned as views on the specified data so tokenizing does not allocate anything.
+ * Only the values which are actually used need to be decoded via percentDecoded() or decoded().
+ */
+
+/*!
+ * \brief Constructs a new reader for the specified \a data.
+ * \remarks The \a data must outlive the reader and the views returned by it.
+ */
+UrlEncodedFormReader::UrlEncodedFormReader(std::string_view data, char separator)
+    : m_data(data)
+    , m_separator(separator)
+{
+}
+
+/*!
+ * \brief Reads the next non-empty part (the raw "name=value" string in the case of a form).
+ * \returns Returns false if there are no further parts.
+ */
+bool UrlEncodedFormReader::readPart(std::string_view &part)
+{
+    while (!m_data.empty()) {
+        const auto end = m_data.find(m_separator);
+        part = m_data.substr(0, end);
+        m_data = end == std::string_view::npos ? std::string_view() : m_data.substr(end + 1);
+        if (!part.empty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*!
+ * \brief Reads the next field.
+ *
+ * The value is everything after the first "=" and is empty if the field has no "=".
+ *
+ * \returns Returns false if there are no further fields.
+ */
+bool UrlEncodedFormReader::readField(std::string_view &name, std::string_view &value)
+{
+    std::string_view part;
+    if (!readPart(part)) {
+        return false;
+    }
+    const auto equalSign = part.find('=');
+    name = part.substr(0, equalSign);
+    value = equalSign == std::string_view::npos ? std::string_view() : part.substr(equalSign + 1);
+    return true;
+}
+
+/*!
+ * \brief Returns the raw value of the field with the specified \a name from the specified \a data.
+ * \remarks If the field occurs multiple times the last non-empty value is returned.
+ */
+std::string_view UrlEncodedFormReader::value(std::string_view data, std::string_view name, char separator)
+{
+    UrlEncodedFormReader reader(data, separator);
+    std::string_view result;
+    for (std::string_view fieldName, fieldValue; reader.readField(fieldName, fieldValue);) {
+        if (fieldName == name && !fieldValue.empty()) {
+            result = fieldValue;
+        }
+    }
+    return result;
+}
+
+/*!
+ * \brief Returns the specified raw \a value with percent-encoded bytes decoded; "+" is kept as-is.
+ */
+QByteArray UrlEncodedFormReader::percentDecoded(std::string_view value)
+{
+    return QByteArray::fromPercentEncoding(QByteArray::fromRawData(value.data(), static_cast<int>(value.size())));
+}
+
+/*!
+ * \brief Returns the specified raw \a value decoded as form value, so "+" is turned into a space as well.
+ */
+QString UrlEncodedFormReader::decoded(std::string_view value)
+{
+    QByteArray bytes(value.data(), static_cast<int>(value.size()));
+    return QString::fromUtf8(QByteArray::fromPercentEncoding(bytes.replace('+', ' ')));
+}
+
+} // namespace Network
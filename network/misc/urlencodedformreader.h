@@ -0,0 +1,39 @@
+#ifndef NETWORK_URLENCODEDFORMREADER_H
+#define NETWORK_URLENCODEDFORMREADER_H
+
+#include <QByteArray>
+#include <QString>
+
+#include <string_view>
+
+namespace Network {
+
+class UrlEncodedFormReader {
+public:
+    explicit UrlEncodedFormReader(std::string_view data, char separator = '&');
+
+    bool readPart(std::string_view &part);
+    bool readField(std::string_view &name, std::string_view &value);
+
+    static std::string_view value(std::string_view data, std::string_view name, char separator = '&');
+    static QByteArray percentDecoded(std::string_view value);
+    static QString decoded(std::string_view value);
+    static std::string_view view(const QByteArray &data);
+
+private:
+    std::string_view m_data;
+    char m_separator;
+};
+
+/*!
+ * \brief Returns a view on the specified \a data.
+ * \remarks The view is only valid as long as \a data is neither modified nor destroyed.
+ */
+inline std::string_view UrlEncodedFormReader::view(const QByteArray &data)
+{
+    return std::string_view(data.constData(), static_cast<std::size_t>(data.size()));
+}
+
+} // namespace Network
+
+#endif // NETWORK_URLENCODEDFORMREADER_H
@@ -22,6 +22,7 @@ OptionData::OptionData(const QString &name, const QUrl &url, size_t redirectsTo,
     , m_outputDevice(nullptr)
     , m_outputDeviceReady(false)
     , m_bytesWritten(0)
+    , m_readBufferSize(0)
     , m_stillWriting(false)
     , m_downloadComplete(false)
     , m_downloadAbortedInternally(false)
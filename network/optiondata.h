@@ -2,6 +2,7 @@
 #define NETWORK_OPTIONDATA_H
 
 #include "./authenticationcredentials.h"
+#include "./misc/transfertimings.h"
 
 #include <QString>
 #include <QUrl>
@@ -31,6 +32,10 @@ public:
     size_t redirectsTo() const;
     size_t redirectionOf() const;
     qint64 bytesWritten() const;
+    bool isBuffering() const;
+    qint64 bufferedBytes() const;
+    qint64 readBufferSize() const;
+    const TransferTimings &transferTimings() const;
     AuthenticationCredentials &authenticationCredentials();
     const AuthenticationCredentials &authenticationCredentials() const;
     PermissionStatus overwritePermission() const;
@@ -51,6 +56,8 @@ private:
     bool m_outputDeviceReady;
     qint64 m_bytesWritten;
     std::unique_ptr<std::stringstream> m_buffer;
+    qint64 m_readBufferSize;
+    TransferTimings m_transferTimings;
     bool m_stillWriting;
     bool m_downloadComplete;
     bool m_downloadAbortedInternally;
@@ -107,6 +114,40 @@ inline qint64 OptionData::bytesWritten() const
     return m_bytesWritten;
 }
 
+/*!
+ * \brief Returns whether received data is currently buffered in memory because the output device is not ready yet.
+ */
+inline bool OptionData::isBuffering() const
+{
+    return m_buffer != nullptr;
+}
+
+/*!
+ * \brief Returns the number of received bytes which are buffered in memory until the output device is ready.
+ */
+inline qint64 OptionData::bufferedBytes() const
+{
+    return m_buffer ? qMax<qint64>(m_buffer->tellp(), 0) : 0;
+}
+
+/*!
+ * \brief Returns the size of the read buffer currently used to receive the data in bytes.
+ * \remarks Zero means the buffer is unlimited or the size is unknown.
+ * \sa Download::reportReadBufferSize()
+ */
+inline qint64 OptionData::readBufferSize() const
+{
+    return m_readBufferSize;
+}
+
+/*!
+ * \brief Returns the timestamps of the phases of the last transfer of this option.
+ */
+inline const TransferTimings &OptionData::transferTimings() const
+{
+    return m_transferTimings;
+}
+
 /*!
  * \brief Returns the authentication credentials provided for this option.
  * \sa Download::provideAuthenticationCredentials()
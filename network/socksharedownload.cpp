@@ -1,10 +1,9 @@
 #include "./socksharedownload.h"
 
-#include "../application/utils.h"
+#include "./misc/textscanner.h"
 
 #include <QUrlQuery>
 
-using namespace Application;
 using namespace CppUtilities;
 
 namespace Network {
@@ -57,15 +56,28 @@ QString SockshareDownload::typeName() const
 
 void SockshareDownload::evalVideoInformation(Download *, QBuffer *videoInfoBuffer)
 {
-    QString videoInfo(videoInfoBuffer->readAll());
+    static const QStringMatcher quoteMarker(QStringLiteral("\""));
+    static const QStringMatcher titleMarker(QStringLiteral("<h1>"));
+    static const QStringMatcher titleEndMarker(QStringLiteral("<"));
+    static const QStringMatcher hashMarker(QStringLiteral("<input type=\"hidden\" value=\""));
+    static const QStringMatcher fileIdMarker(QStringLiteral("get_file.php?id="));
+    static const QStringMatcher playlistMarker(QStringLiteral("get_file.php?"));
+    static const QStringMatcher playlistEndMarker(QStringLiteral("'"));
+    static const QStringMatcher mediaContentMarker(QStringLiteral("<media:content"));
+    static const QStringMatcher urlMarker(QStringLiteral("url=\""));
+    static const QStringMatcher durationMarker(QStringLiteral("duration=\""));
+
+    const QString videoInfo(videoInfoBuffer->readAll());
+    TextScanner scanner(videoInfo);
     int pos;
     QString str;
     switch (m_currentStep) {
     case 0:
-        if (substring(videoInfo, str, 0, QStringLiteral("<h1>"), QStringLiteral("<")) > 0 && !str.isEmpty()) {
+        if (scanner.extract(titleMarker, titleEndMarker, str) && !str.isEmpty()) {
             setTitle(str);
         }
-        if (substring(videoInfo, str, 0, QStringLiteral("<input type=\"hidden\" value=\""), QStringLiteral("\"")) > 0) {
+        scanner.setPosition(0);
+        if (scanner.extract(hashMarker, quoteMarker, str)) {
             if (str.isEmpty()) {
                 reportInitiated(false, tr("Couldn't find the hash (empty \"value\"-attribute)."));
             } else {
@@ -80,9 +92,10 @@ void SockshareDownload::evalVideoInformation(Download *, QBuffer *videoInfoBuffe
             reportInitiated(false, QStringLiteral("Couldn't find the hash."));
         break;
     case 1:
-        if (substring(videoInfo, str, 0, QStringLiteral("get_file.php?id="), QStringLiteral("\"")))
+        if (scanner.extract(fileIdMarker, quoteMarker, str))
             addDownloadUrl(tr("H.263/MP3/AVI"), QUrl(QStringLiteral("http://%1/get_file.php?id=%2").arg(initialUrl().host(), str)));
-        if (substring(videoInfo, str, 0, QStringLiteral("get_file.php?"), QStringLiteral("'")) != -1) {
+        scanner.setPosition(0);
+        if (scanner.extract(playlistMarker, playlistEndMarker, str)) {
             m_playlistUrl = QUrl(QStringLiteral("http://%1/get_file.php?%2").arg(initialUrl().host(), str));
             ++m_currentStep;
             doInit();
@@ -95,9 +108,10 @@ void SockshareDownload::evalVideoInformation(Download *, QBuffer *videoInfoBuffe
         }
         break;
     case 2:
-        pos = videoInfo.indexOf(QLatin1String("<media:content"));
-        if (pos > 0) {
-            if (substring(videoInfo, str, pos, QStringLiteral("url=\""), QStringLiteral("\"")) > 0) {
+        if (scanner.skipTo(mediaContentMarker)) {
+            // the attributes of the "media"-tag might be in any order
+            pos = scanner.position();
+            if (scanner.extract(urlMarker, quoteMarker, str)) {
                 if (str.isEmpty()) {
                     if (availableOptionCount() < 1) {
                         reportInitiated(false, tr("The \"url\"-attribute in the \"media\"-tag is empty."));
@@ -108,7 +122,8 @@ void SockshareDownload::evalVideoInformation(Download *, QBuffer *videoInfoBuffe
                     str = str.replace(QLatin1String("&amp;"), QLatin1String("&"));
                     addDownloadUrl(tr("H.264/AAC/FLV"), QUrl(str));
                     setChosenOption(availableOptionCount() - 1);
-                    if (substring(videoInfo, str, pos, QStringLiteral("duration=\""), QStringLiteral("\""))) {
+                    scanner.setPosition(pos);
+                    if (scanner.extract(durationMarker, quoteMarker, str)) {
                         bool ok;
                         int duration = str.toInt(&ok);
                         if (ok)
@@ -1,18 +1,41 @@
 #include "./youtubedownload.h"
 
+#include "./misc/urlencodedformreader.h"
+
 #include "../application/utils.h"
 
 #include "resources/config.h"
+#include "resources/itaginfo.h"
 
-#include <QJsonDocument>
 #include <QUrlQuery>
 
+#include <iterator>
+
 using namespace CppUtilities;
 using namespace Application;
 
 namespace Network {
 
-QJsonObject YoutubeDownload::m_itagInfo = QJsonObject();
+/*!
+ * \brief Returns the information about the specified \a itag or nullptr if the itag is unknown.
+ */
+static const ItagInfo::Entry *itagInfo(const QString &itag)
+{
+    bool ok;
+    const auto index = itag.toUInt(&ok);
+    if (!ok || index >= std::size(ItagInfo::entries) || !ItagInfo::entries[index].known) {
+        return nullptr;
+    }
+    return ItagInfo::entries + index;
+}
+
+/*!
+ * \brief Returns the value with the specified \a stringIndex from the itag information.
+ */
+static QString itagString(std::uint8_t stringIndex)
+{
+    return QString::fromUtf8(ItagInfo::strings[stringIndex]);
+}
 
 /*!
  * \class YoutubeDownload
@@ -58,102 +81,85 @@ Download *YoutubeDownload::infoRequestDownload(bool &success, QString &reasonFor
 
 void YoutubeDownload::evalVideoInformation(Download *, QBuffer *videoInfoBuffer)
 {
-    if (m_itagInfo.isEmpty()) {
-        m_itagInfo = loadJsonObjectFromResource(QStringLiteral(":/jsonobjects/itaginfo"));
-    }
-    QString videoInfo(videoInfoBuffer->readAll());
-    QStringList completeFields = videoInfo.split(QChar('&'), Qt::SkipEmptyParts, Qt::CaseSensitive);
-    for (const QString &completeField : completeFields) {
-        QStringList fieldParts = completeField.split(QChar('='), Qt::SkipEmptyParts, Qt::CaseSensitive);
-        if (fieldParts.count() < 2) {
-            continue;
-        }
-        m_fields.insert(QUrl::fromPercentEncoding(fieldParts.at(0).toUtf8()), QUrl::fromPercentEncoding(fieldParts.at(1).toUtf8()));
-    }
-    QString status = m_fields.value(QStringLiteral("status"));
-    if (status == QLatin1String("ok")) {
-        QString title = m_fields.value(QStringLiteral("title"));
+    // tokenize the video info in-place and only decode the fields which are actually used
+    m_videoInfo = videoInfoBuffer->readAll();
+    const auto videoInfo = UrlEncodedFormReader::view(m_videoInfo);
+    const auto field = [videoInfo](std::string_view name) { return UrlEncodedFormReader::value(videoInfo, name); };
+    if (field("status") == "ok") {
+        const QString title = UrlEncodedFormReader::decoded(field("title"));
         if (!title.isEmpty()) {
-            setTitle(title.replace(QChar('+'), QChar(' ')));
+            setTitle(title);
         }
-        QString uploader = m_fields.value(QStringLiteral("author"));
+        const QString uploader = UrlEncodedFormReader::decoded(field("author"));
         if (!uploader.isEmpty()) {
-            setUploader(uploader.replace(QChar('+'), QChar(' ')));
+            setUploader(uploader);
         }
         bool ok;
-        double duration = m_fields.value(QStringLiteral("length_seconds")).toDouble(&ok);
+        double duration = UrlEncodedFormReader::percentDecoded(field("length_seconds")).toDouble(&ok);
         if (ok) {
             setDuration(TimeSpan::fromSeconds(duration));
         }
-        QString rating = m_fields.value(QStringLiteral("avg_rating"));
+        const QString rating = QString::fromUtf8(UrlEncodedFormReader::percentDecoded(field("avg_rating")));
         if (!rating.isEmpty()) {
             setRating(rating);
         }
-        QStringList fmtFieldIds = QStringList() << QStringLiteral("url_encoded_fmt_stream_map") << QStringLiteral("adaptive_fmts");
-        for (const QString &fmtFieldId : fmtFieldIds) {
-            QString fmtField = m_fields.value(fmtFieldId, QString());
-            if (!fmtField.isEmpty()) {
-                QStringList sections = fmtField.split(QChar(','), Qt::SkipEmptyParts, Qt::CaseSensitive);
-                for (const QString &section : sections) {
-                    QStringList fmtParts = section.split(QChar('&'), Qt::SkipEmptyParts, Qt::CaseSensitive);
-                    QString itag, urlPart1, urlPart2, name;
-                    QJsonObject itagObj;
-                    for (const QString fmtPart : fmtParts) {
-                        QStringList fmtSubParts = fmtPart.split(QChar('='), Qt::SkipEmptyParts, Qt::CaseSensitive);
-                        if (fmtSubParts.count() >= 2) {
-                            QString fieldIdentifier = fmtSubParts.at(0).toLower();
-                            if (fieldIdentifier == QLatin1String("url")) {
-                                urlPart1 = QUrl::fromPercentEncoding(fmtSubParts.at(1).toUtf8());
-                            } else if (fieldIdentifier == QLatin1String("sig")) {
-                                urlPart2 = QUrl::fromPercentEncoding(fmtSubParts.at(1).toUtf8());
-                            } else if (fieldIdentifier == QLatin1String("itag")) {
-                                itag = fmtSubParts.at(1);
-                            }
-                        }
+        for (const std::string_view fmtFieldId : { std::string_view("url_encoded_fmt_stream_map"), std::string_view("adaptive_fmts") }) {
+            const QByteArray fmtField = UrlEncodedFormReader::percentDecoded(field(fmtFieldId));
+            UrlEncodedFormReader sections(UrlEncodedFormReader::view(fmtField), ',');
+            for (std::string_view section; sections.readPart(section);) {
+                UrlEncodedFormReader fmtParts(section);
+                std::string_view rawItag, urlPart1, urlPart2;
+                for (std::string_view fieldIdentifier, value; fmtParts.readField(fieldIdentifier, value);) {
+                    if (value.empty()) {
+                        continue;
                     }
-                    if (!itag.isEmpty() && !urlPart1.isEmpty()) {
-                        if (m_itagInfo.contains(itag)) {
-                            itagObj = m_itagInfo.value(itag).toObject();
-                            name.append(itagObj.value(QStringLiteral("container")).toString());
-                            const QString videoCodec = itagObj.value(QStringLiteral("videoCodec")).toString();
-                            const QString audioCodec = itagObj.value(QStringLiteral("audioCodec")).toString();
-                            if (!videoCodec.isEmpty()) {
-                                name.append(QChar('/'));
-                                name.append(videoCodec);
-                            }
-                            if (!audioCodec.isEmpty()) {
-                                name.append(QChar('/'));
-                                name.append(audioCodec);
-                            }
-                            if (!videoCodec.isEmpty()) {
-                                name.append(QStringLiteral(", "));
-                                name.append(itagObj.value(QStringLiteral("videoResolution")).toString());
-                            }
-                            if (videoCodec.isEmpty()) {
-                                name.append(tr(", no video"));
-                                const QString audioBitrate = itagObj.value(QStringLiteral("audioBitrate")).toString();
-                                if (!audioBitrate.isEmpty()) {
-                                    name.append(tr(", %1 kbit/s").arg(audioBitrate));
-                                }
-                            }
-                            if (audioCodec.isEmpty()) {
-                                name.append(tr(", no audio"));
-                            }
-                            name.append(QStringLiteral(" ("));
-                            name.append(itag);
-                            name.append(QStringLiteral(")"));
+                    if (equalsIgnoringCase(fieldIdentifier, "url")) {
+                        urlPart1 = value;
+                    } else if (equalsIgnoringCase(fieldIdentifier, "sig")) {
+                        urlPart2 = value;
+                    } else if (equalsIgnoringCase(fieldIdentifier, "itag")) {
+                        rawItag = value;
+                    }
+                }
+                if (!rawItag.empty() && !urlPart1.empty()) {
+                    const QString itag = QString::fromLatin1(rawItag.data(), static_cast<int>(rawItag.size()));
+                    QString name;
+                    if (const ItagInfo::Entry *const info = itagInfo(itag)) {
+                        name.append(itagString(info->container));
+                        if (info->videoCodec) {
+                            name.append(QChar('/'));
+                            name.append(itagString(info->videoCodec));
+                        }
+                        if (info->audioCodec) {
+                            name.append(QChar('/'));
+                            name.append(itagString(info->audioCodec));
+                        }
+                        if (info->videoCodec) {
+                            name.append(QStringLiteral(", "));
+                            name.append(itagString(info->videoResolution));
                         } else {
-                            name = itag;
+                            name.append(tr(", no video"));
+                            if (info->audioBitrate) {
+                                name.append(tr(", %1 kbit/s").arg(itagString(info->audioBitrate)));
+                            }
                         }
-                        QByteArray url;
-                        url.append(urlPart1.toUtf8());
-                        if (!urlPart2.isEmpty()) {
-                            url.append("&signature=");
-                            url.append(urlPart2.toUtf8());
+                        if (!info->audioCodec) {
+                            name.append(tr(", no audio"));
                         }
-                        addDownloadUrl(name, QUrl::fromPercentEncoding(url));
-                        m_itags.append(itag);
+                        name.append(QStringLiteral(" ("));
+                        name.append(itag);
+                        name.append(QStringLiteral(")"));
+                    } else {
+                        name = itag;
+                    }
+                    QByteArray url;
+                    url.append(UrlEncodedFormReader::percentDecoded(urlPart1));
+                    if (!urlPart2.empty()) {
+                        url.append("&signature=");
+                        url.append(UrlEncodedFormReader::percentDecoded(urlPart2));
                     }
+                    addDownloadUrl(name, QUrl::fromPercentEncoding(url));
+                    m_itags.append(itag);
                 }
             }
         }
@@ -164,20 +170,27 @@ void YoutubeDownload::evalVideoInformation(Download *, QBuffer *videoInfoBuffer)
                 tr("Couldn't pharse the video info. The status of the video info is ok, but it seems like YouTube changed something in their API."));
         }
     } else {
-        QString reason = m_fields.value("reason");
+        const QString reason = UrlEncodedFormReader::decoded(field("reason"));
         if (reason.isEmpty()) {
             reportInitiated(false,
                 tr("Failed to retrieve the video info. The reason couldn't be identified. It seems like YouTube changed something in their API."));
         } else {
-            reportInitiated(false,
-                tr("Failed to retrieve the video info. The reason returned by Youtube is: \"%1\".").arg(reason.replace(QChar('+'), QChar(' '))));
+            // the reason is given when the video has been removed or is not available so don't retry it for a while
+            reportInitiationFailedPermanently(
+                tr("Failed to retrieve the video info. The reason returned by Youtube is: \"%1\".").arg(reason));
         }
     }
 }
 
+/*!
+ * \brief Returns the value of the specified \a field of the video info or \a defaultValue if the field is not present.
+ * \remarks The value is decoded on each call.
+ */
 QString YoutubeDownload::videoInfo(QString field, const QString &defaultValue)
 {
-    return m_fields.value(field, defaultValue);
+    const QByteArray name = field.toUtf8();
+    const auto value = UrlEncodedFormReader::value(UrlEncodedFormReader::view(m_videoInfo), UrlEncodedFormReader::view(name));
+    return value.empty() ? defaultValue : QString::fromUtf8(UrlEncodedFormReader::percentDecoded(value));
 }
 
 QString YoutubeDownload::suitableFilename() const
@@ -190,13 +203,8 @@ QString YoutubeDownload::suitableFilename() const
     }
     QString extension;
     if (originalOption < static_cast<std::size_t>(m_itags.size())) {
-        const auto itag = m_itags.at(originalOption);
-        if (m_itagInfo.contains(itag)) {
-            const auto itagObj = m_itagInfo.value(itag).toObject();
-            extension = itagObj.value(QStringLiteral("ext")).toString();
-            if (extension.isEmpty()) {
-                extension = itagObj.value(QStringLiteral("container")).toString().toLower();
-            }
+        if (const ItagInfo::Entry *const info = itagInfo(m_itags.at(originalOption))) {
+            extension = info->ext ? itagString(info->ext) : itagString(info->container).toLower();
         }
     }
     if (extension.isEmpty()) {
@@ -3,8 +3,6 @@
 
 #include "./httpdownloadwithinforequst.h"
 
-#include <QHash>
-#include <QJsonObject>
 #include <QStringList>
 
 namespace Network {
@@ -25,9 +23,8 @@ protected:
     void evalVideoInformation(Download *, QBuffer *videoInfoBuffer);
 
 private:
-    QHash<QString, QString> m_fields;
+    QByteArray m_videoInfo;
     QStringList m_itags;
-    static QJsonObject m_itagInfo;
 };
 } // namespace Network
 